@@ -0,0 +1,358 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+/*
+ * Benchmarks of the simulator, its TCP interface, and complete missions
+ *
+ * It accepts the options of Google Benchmark. Unless --benchmark_out is
+ * given, the results are also written in JSON to dartsim-bench.json, so
+ * that they can be compared across releases (e.g., with the compare.py
+ * tool of Google Benchmark).
+ */
+#include <dartsim/Simulator.h>
+#include "RealEnvironment.h"
+#include "AdaptInterface.h"
+#include <benchmark/benchmark.h>
+#include <boost/asio.hpp>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace dart::sim;
+
+namespace {
+
+const char* const DEFAULT_OUTPUT = "dartsim-bench.json";
+
+/*
+ * Creates a simulator for a long straight route, so that benchmarks can
+ * step it many times before the mission finishes
+ */
+unique_ptr<Simulator> createLongMission(int seed, bool recordTrajectory = false) {
+	SimulationParams simParams;
+	simParams.mapSize = 100000;
+	simParams.recordTrajectory = recordTrajectory;
+	ScenarioParams scenarioParams;
+	scenarioParams.numThreats = 0;
+	scenarioParams.numTargets = 1000;
+	scenarioParams.seeded = true;
+	scenarioParams.seed = seed;
+	return unique_ptr<Simulator>(Simulator::createInstance(simParams, scenarioParams));
+}
+
+/*
+ * Decides the tactics of a step as the simple-cpp example does
+ */
+TacticSet decideTactics(Simulator& sim, unsigned maxAltitude) {
+	const unsigned HORIZON = 5;
+	bool threats[HORIZON];
+	bool targets[HORIZON];
+	TeamState state;
+	sim.getState(state);
+	unsigned cells = sim.readForwardThreatSensor(HORIZON, threats);
+	sim.readForwardTargetSensor(HORIZON, targets);
+
+	bool threatAhead = false;
+	bool targetAhead = false;
+	for (unsigned c = 0; c < cells; c++) {
+		threatAhead = threatAhead || threats[c];
+		targetAhead = targetAhead || targets[c];
+	}
+
+	TacticSet tactics;
+	if (threatAhead && state.config.altitudeLevel < maxAltitude) {
+		tactics.insert(Tactic::INC_ALTITUDE);
+	} else if (targetAhead && state.config.altitudeLevel > 1) {
+		tactics.insert(Tactic::DEC_ALTITUDE);
+	}
+
+	if (cells > 0 && threats[0]) {
+		if (state.config.formation != TeamConfiguration::Formation::TIGHT) {
+			tactics.insert(Tactic::GO_TIGHT);
+		}
+	} else if (state.config.formation != TeamConfiguration::Formation::LOOSE) {
+		tactics.insert(Tactic::GO_LOOSE);
+	}
+	return tactics;
+}
+
+}
+
+/*
+ * args: map size (of each side), sparse storage
+ */
+static void BM_Populate(benchmark::State& state) {
+	const int size = state.range(0);
+	auto storage = state.range(1) ? RealEnvironment::Storage::SPARSE : RealEnvironment::Storage::DENSE;
+	uint64_t seed = 0;
+	for (auto _ : state) {
+		RealEnvironment environment(storage);
+		environment.populate(Coordinate(size, size), size, RandomStream(seed++));
+		benchmark::DoNotOptimize(environment);
+	}
+}
+BENCHMARK(BM_Populate)->ArgNames({"size", "sparse"})
+	->ArgsProduct({{40, 400, 4000}, {0, 1}});
+
+/*
+ * args: map size (of each side), percentage of the cells with objects
+ */
+static void BM_PopulateDensity(benchmark::State& state) {
+	const int size = state.range(0);
+	const unsigned numOfObjects = uint64_t(size) * size * state.range(1) / 100;
+	uint64_t seed = 0;
+	for (auto _ : state) {
+		RealEnvironment environment;
+		environment.populate(Coordinate(size, size), numOfObjects, RandomStream(seed++));
+		benchmark::DoNotOptimize(environment);
+	}
+	state.SetItemsProcessed(state.iterations() * numOfObjects);
+}
+BENCHMARK(BM_PopulateDensity)->ArgNames({"size", "percent"})
+	->ArgsProduct({{400, 2000}, {10, 50, 90, 100}})->Unit(benchmark::kMillisecond);
+
+/*
+ * args: map size (of each side), sparse storage
+ */
+static void BM_IsObjectAt(benchmark::State& state) {
+	const int size = state.range(0);
+	auto storage = state.range(1) ? RealEnvironment::Storage::SPARSE : RealEnvironment::Storage::DENSE;
+	RealEnvironment environment(storage);
+	environment.populate(Coordinate(size, size), size, RandomStream(1));
+
+	const unsigned NUM_LOCATIONS = 1024;
+	vector<Coordinate> locations;
+	RandomStream random(2);
+	for (unsigned l = 0; l < NUM_LOCATIONS; l++) {
+		locations.push_back(Coordinate(random() % size, random() % size));
+	}
+
+	unsigned l = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(environment.isObjectAt(locations[l++ % NUM_LOCATIONS]));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IsObjectAt)->ArgNames({"size", "sparse"})
+	->ArgsProduct({{40, 400, 4000}, {0, 1}});
+
+/*
+ * args: number of observations of each of the 5 cells ahead
+ */
+static void BM_ReadForwardSensor(benchmark::State& state) {
+	const unsigned CELLS = 5;
+	const unsigned observations = state.range(0);
+	auto sim = createLongMission(1);
+	SensorReadings readings;
+	for (auto _ : state) {
+		sim->readForwardThreatSensor(CELLS, observations, readings);
+		benchmark::DoNotOptimize(readings.counts.data());
+	}
+	state.SetItemsProcessed(state.iterations() * CELLS * observations);
+}
+BENCHMARK(BM_ReadForwardSensor)->ArgName("observations")->Arg(1)->Arg(10)->Arg(100);
+
+/*
+ * Same as BM_ReadForwardSensor with the interface that returns vectors
+ */
+static void BM_ReadForwardSensorVectors(benchmark::State& state) {
+	const unsigned CELLS = 5;
+	const unsigned observations = state.range(0);
+	auto sim = createLongMission(1);
+	for (auto _ : state) {
+		auto readings = sim->readForwardThreatSensor(CELLS, observations);
+		benchmark::DoNotOptimize(readings.data());
+	}
+	state.SetItemsProcessed(state.iterations() * CELLS * observations);
+}
+BENCHMARK(BM_ReadForwardSensorVectors)->ArgName("observations")->Arg(1)->Arg(10)->Arg(100);
+
+static void BM_Step(benchmark::State& state) {
+	int seed = 1;
+	auto sim = createLongMission(seed);
+	const TacticSet tight = { Tactic::GO_TIGHT };
+	const TacticSet loose = { Tactic::GO_LOOSE };
+	bool goTight = false;
+	for (auto _ : state) {
+		if (sim->finished()) {
+			state.PauseTiming();
+			sim = createLongMission(++seed);
+			state.ResumeTiming();
+		}
+		goTight = !goTight;
+		benchmark::DoNotOptimize(sim->step(goTight ? tight : loose));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Step);
+
+/*
+ * Same as BM_Step with the tactics as a TacticList of labels
+ */
+static void BM_StepTacticList(benchmark::State& state) {
+	int seed = 1;
+	auto sim = createLongMission(seed);
+	const Simulator::TacticList tight = { Simulator::GO_TIGHT };
+	const Simulator::TacticList loose = { Simulator::GO_LOOSE };
+	bool goTight = false;
+	for (auto _ : state) {
+		if (sim->finished()) {
+			state.PauseTiming();
+			sim = createLongMission(++seed);
+			state.ResumeTiming();
+		}
+		goTight = !goTight;
+		benchmark::DoNotOptimize(sim->step(goTight ? tight : loose));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StepTacticList);
+
+/*
+ * Forks of a simulator that records its trajectory, after the given number
+ * of steps of a long route
+ */
+static void BM_Fork(benchmark::State& state) {
+	auto sim = createLongMission(1, true);
+	for (int s = 0; s < state.range(0); s++) {
+		sim->step(TacticSet(), 1.0);
+	}
+	for (auto _ : state) {
+		unique_ptr<Simulator> fork(sim->fork());
+		benchmark::DoNotOptimize(fork.get());
+	}
+}
+BENCHMARK(BM_Fork)->ArgName("steps")->Arg(0)->Arg(10000)->Arg(90000);
+
+/*
+ * Same as BM_Fork taking and restoring a snapshot, with a step in between
+ * so that the restore rewinds the simulation
+ */
+static void BM_SnapshotRestore(benchmark::State& state) {
+	auto sim = createLongMission(1, true);
+	for (int s = 0; s < state.range(0); s++) {
+		sim->step(TacticSet(), 1.0);
+	}
+	for (auto _ : state) {
+		auto snapshot = sim->snapshot();
+		sim->step(TacticSet(), 1.0);
+		sim->restore(*snapshot);
+	}
+}
+BENCHMARK(BM_SnapshotRestore)->ArgName("steps")->Arg(0)->Arg(10000)->Arg(90000);
+
+/*
+ * Round trip of a text command sent to AdaptInterface over loopback
+ *
+ * args: 0 for getState, 1 for readForwardThreatSensor
+ */
+static void BM_AdaptInterfaceRoundTrip(benchmark::State& state) {
+	using boost::asio::ip::tcp;
+	const string command = state.range(0) ? "readForwardThreatSensor 5\n" : "getState\n";
+
+	auto sim = createLongMission(1);
+	AdaptInterface interface(sim.get(), 0);
+	thread server([&interface]() { interface.serviceClient(); });
+
+	boost::asio::io_service ioService;
+	tcp::socket socket(ioService);
+	socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), interface.getPort()));
+	socket.set_option(tcp::no_delay(true));
+	boost::asio::streambuf reply;
+
+	for (auto _ : state) {
+		boost::asio::write(socket, boost::asio::buffer(command));
+		size_t length = boost::asio::read_until(socket, reply, '\n');
+		reply.consume(length);
+	}
+	state.SetItemsProcessed(state.iterations());
+
+	socket.close();
+	server.join();
+}
+BENCHMARK(BM_AdaptInterfaceRoundTrip)->ArgName("command")->Arg(0)->Arg(1)->UseRealTime();
+
+/*
+ * Complete missions with the adaptation manager of simple-cpp
+ *
+ * args: 0 for a straight map, 1 for a square map
+ */
+static void BM_Mission(benchmark::State& state) {
+	SimulationParams simParams;
+	simParams.squareMap = state.range(0);
+	simParams.recordTrajectory = false;
+	ScenarioParams scenarioParams;
+	scenarioParams.seeded = true;
+	if (simParams.squareMap) {
+		scenarioParams.numThreats = simParams.mapSize;
+		scenarioParams.numTargets = simParams.mapSize;
+	}
+
+	size_t steps = 0;
+	int seed = 0;
+	for (auto _ : state) {
+		scenarioParams.seed = ++seed;
+		unique_ptr<Simulator> sim(Simulator::createInstance(simParams, scenarioParams));
+		while (!sim->finished()) {
+			sim->step(decideTactics(*sim, simParams.altitudeLevels));
+			steps++;
+		}
+		benchmark::DoNotOptimize(sim->getResults());
+	}
+	state.counters["steps"] = benchmark::Counter(steps, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Mission)->ArgName("square")->Arg(0)->Arg(1);
+
+int main(int argc, char** argv) {
+	vector<char*> args(argv, argv + argc);
+
+	bool hasOutput = false;
+	for (int a = 1; a < argc; a++) {
+		hasOutput = hasOutput || strncmp(argv[a], "--benchmark_out=", 16) == 0;
+	}
+
+	string outputArg = string("--benchmark_out=") + DEFAULT_OUTPUT;
+	string formatArg = "--benchmark_out_format=json";
+	if (!hasOutput) {
+		args.push_back(&outputArg[0]);
+		args.push_back(&formatArg[0]);
+	}
+
+	int numOfArgs = args.size();
+	args.push_back(nullptr);
+	benchmark::Initialize(&numOfArgs, args.data());
+	if (benchmark::ReportUnrecognizedArguments(numOfArgs, args.data())) {
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
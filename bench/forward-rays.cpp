@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+/*
+ * Checks that the forward-looking sensors read the same cells as the loop
+ * over Route(position, directionX, directionY, cells) that they replaced,
+ * and that Simulator::getForwardCells() returns the cells of that route.
+ *
+ * Sensor errors are disabled, so each reading is the presence of a target
+ * in the cell. Square maps of several sizes are traversed moving right,
+ * down, left and up, reading more cells than the map is long, and reading
+ * again after the mission ends, when the team has no direction. The exit
+ * status is non-zero if any read differs from the old loop.
+ */
+#include <dartsim/Simulator.h>
+#include "RealEnvironment.h"
+#include "SeedContext.h"
+#include "SimulatorImpl.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace dart::sim;
+
+namespace {
+
+/*
+ * Route that covers the map row by row and then goes back up the column
+ * where it ends, so that it moves in the four directions
+ */
+shared_ptr<Route> createRoute(CoordT size) {
+	auto route = make_shared<Route>();
+	for (CoordT y = 0; y < size; y++) {
+		for (CoordT i = 0; i < size; i++) {
+			route->push_back(Coordinate((y % 2 == 0) ? i : size - 1 - i, y));
+		}
+	}
+	const CoordT x = route->back().x;
+	for (CoordT y = size - 2; y >= 0; y--) {
+		route->push_back(Coordinate(x, y));
+	}
+	return route;
+}
+
+/*
+ * Reads the cells as the simulator did before the route geometry was
+ * precomputed
+ */
+vector<bool> readBaseline(const RealEnvironment& environment, const TeamState& state, unsigned cells) {
+	vector<bool> sensed;
+	for (const auto& pos : Route(state.position, state.directionX, state.directionY, cells)) {
+		if (!pos.isInsideRect(environment.getSize())) {
+			break;
+		}
+		sensed.push_back(environment.isObjectAt(pos));
+	}
+	return sensed;
+}
+
+/*
+ * Compares all the forward sensor reads with the baseline
+ *
+ * @return number of reads that differ
+ */
+unsigned check(Simulator& sim, const RealEnvironment& targets, CoordT size) {
+	TeamState state;
+	sim.getState(state);
+
+	unsigned mismatches = 0;
+	const unsigned cellCounts[] = { 1, unsigned(size), unsigned(size) + 1, 2 * unsigned(size) + 3 };
+	for (unsigned cells : cellCounts) {
+		const auto expected = readBaseline(targets, state, cells);
+
+		const auto sensed = sim.readForwardTargetSensor(cells);
+
+		unique_ptr<bool[]> buffer(new bool[cells]);
+		const unsigned bufferCells = sim.readForwardTargetSensor(cells, buffer.get());
+
+		SensorReadings readings;
+		sim.readForwardTargetSensor(cells, 1, readings);
+
+		const auto counts = sim.readForwardTargetSensorCounts(cells, 1);
+
+		Route forwardCells;
+		sim.getForwardCells(cells, forwardCells);
+		const Route route(state.position, state.directionX, state.directionY, cells);
+
+		bool same = forwardCells == route && sensed == expected && bufferCells == expected.size()
+				&& readings.cells == expected.size() && counts.size() == expected.size();
+		for (unsigned c = 0; same && c < expected.size(); c++) {
+			same = buffer[c] == expected[c] && readings.get(c, 0) == expected[c]
+					&& (counts[c] > 0) == expected[c];
+		}
+		if (!same) {
+			cout << "mismatch: size=" << size << " position=" << state.position
+					<< " direction=" << state.directionX << ',' << state.directionY
+					<< " cells=" << cells << " expected=" << expected.size()
+					<< " sensed=" << sensed.size() << endl;
+			mismatches++;
+		}
+	}
+
+	return mismatches;
+}
+
+}
+
+int main() {
+	SimulationParams simParams;
+	simParams.longRangeSensor.targetSensorFPR = 0;
+	simParams.longRangeSensor.targetSensorFNR = 0;
+	simParams.recordTrajectory = false;
+
+	unsigned reads = 0;
+	unsigned mismatches = 0;
+	for (CoordT size = 1; size <= 6; size++) {
+		SeedContext seedContext(size);
+		RealEnvironment threats;
+		threats.populate(Coordinate(size, size), 0, seedContext.getStream(SeedContext::THREAT));
+		RealEnvironment targets;
+		targets.populate(Coordinate(size, size), size * size / 2, seedContext.getStream(SeedContext::TARGET_SENSOR));
+
+		SimulatorImpl sim(simParams, seedContext, threats, targets, createRoute(size), 0);
+		while (!sim.finished()) {
+			mismatches += check(sim, targets, size);
+			reads++;
+			sim.step(TacticSet());
+		}
+
+		// the team stays at the end of the route without a direction
+		mismatches += check(sim, targets, size);
+		reads++;
+	}
+
+	const std::string RESULTS_PREFIX = "out:";
+	cout << RESULTS_PREFIX << "positions=" << reads << endl;
+	cout << RESULTS_PREFIX << "mismatches=" << mismatches << endl;
+
+	return (mismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,159 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+/*
+ * Counts the heap allocations done while running missions with the
+ * allocation-free overloads of Simulator, which should be zero.
+ *
+ * It accepts the same options as the simulator, and runs one mission for
+ * each seed in [1, missions]. The exit status is non-zero if any step of a
+ * mission allocated memory.
+ */
+#include <dartsim/Simulator.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+
+using namespace std;
+using namespace dart::sim;
+
+namespace {
+
+size_t allocations = 0;
+
+const unsigned MISSIONS = 100;
+const unsigned HORIZON = 5;
+const unsigned OBSERVATIONS = 10;
+
+}
+
+void* operator new(size_t size) {
+	allocations++;
+	void* p = malloc(size ? size : 1);
+	if (!p) {
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+	allocations++;
+	return malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept {
+	free(p);
+}
+
+int main(int argc, char** argv) {
+	SimulationParams simParams;
+	ScenarioParams scenarioParams;
+	if (!Simulator::parseArguments(argc, argv, simParams, scenarioParams)) {
+		Simulator::usage();
+		return EXIT_FAILURE;
+	}
+
+	const unsigned minAltitude = 1;
+	const unsigned maxAltitude = simParams.altitudeLevels;
+
+	bool threats[HORIZON];
+	bool targets[HORIZON];
+	SensorReadings readings;
+	TeamState state;
+
+	size_t steps = 0;
+	size_t stepAllocations = 0;
+	chrono::steady_clock::duration stepTime(0);
+
+	for (unsigned mission = 1; mission <= MISSIONS; mission++) {
+		scenarioParams.seeded = true;
+		scenarioParams.seed = mission;
+		unique_ptr<Simulator> sim(Simulator::createInstance(simParams, scenarioParams));
+		if (!sim) {
+			return EXIT_FAILURE;
+		}
+
+		// let the readings grow to their size before counting
+		sim->readForwardThreatSensor(HORIZON, OBSERVATIONS, readings);
+
+		auto startTime = chrono::steady_clock::now();
+		size_t startAllocations = allocations;
+		while (!sim->finished()) {
+			sim->getState(state);
+			unsigned cells = sim->readForwardThreatSensor(HORIZON, threats);
+			sim->readForwardTargetSensor(HORIZON, targets);
+			sim->readForwardThreatSensor(HORIZON, OBSERVATIONS, readings);
+
+			TacticSet tactics;
+			bool threatAhead = false;
+			bool targetAhead = false;
+			for (unsigned c = 0; c < cells; c++) {
+				threatAhead = threatAhead || threats[c];
+				targetAhead = targetAhead || targets[c];
+			}
+			if (threatAhead && state.config.altitudeLevel < maxAltitude) {
+				tactics.insert(Tactic::INC_ALTITUDE);
+			} else if (targetAhead && state.config.altitudeLevel > minAltitude) {
+				tactics.insert(Tactic::DEC_ALTITUDE);
+			}
+
+			if (cells > 0 && threats[0]) {
+				if (state.config.formation != TeamConfiguration::Formation::TIGHT) {
+					tactics.insert(Tactic::GO_TIGHT);
+				}
+			} else if (state.config.formation != TeamConfiguration::Formation::LOOSE) {
+				tactics.insert(Tactic::GO_LOOSE);
+			}
+
+			sim->step(tactics);
+			steps++;
+		}
+		stepAllocations += allocations - startAllocations;
+		stepTime += chrono::steady_clock::now() - startTime;
+	}
+
+	const std::string RESULTS_PREFIX = "out:";
+	cout << RESULTS_PREFIX << "missions=" << MISSIONS << endl;
+	cout << RESULTS_PREFIX << "steps=" << steps << endl;
+	cout << RESULTS_PREFIX << "allocations=" << stepAllocations << endl;
+	cout << RESULTS_PREFIX << "allocationsPerStep=" << double(stepAllocations) / steps << endl;
+	cout << RESULTS_PREFIX << "nsecPerStep="
+			<< chrono::duration<double, nano>(stepTime).count() / steps << endl;
+
+	return (stepAllocations == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
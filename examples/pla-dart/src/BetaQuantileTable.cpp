@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#include "BetaQuantileTable.h"
+#include "EnvironmentMonitor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace dart {
+namespace am2 {
+
+namespace {
+
+/* index of the first entry for the counts in the triangular table */
+size_t countsIndex(unsigned observations, unsigned detections) {
+	return size_t(observations) * (observations + 1) / 2 + detections;
+}
+
+}
+
+BetaQuantileTable::BetaQuantileTable(const std::vector<double>& quantiles)
+	: quantiles(quantiles)
+{
+}
+
+double BetaQuantileTable::getQuantile(unsigned observations, unsigned detections, unsigned q) {
+	if (observations > MAX_OBSERVATIONS || detections > observations) {
+		return boost::math::quantile(
+				EnvironmentMonitor::getBetaDistribution(observations, detections),
+				quantiles.at(q));
+	}
+
+	double& entry = getEntry(observations, detections, q);
+	if (std::isnan(entry)) {
+		entry = boost::math::quantile(
+				EnvironmentMonitor::getBetaDistribution(observations, detections),
+				quantiles.at(q));
+	}
+	return entry;
+}
+
+void BetaQuantileTable::prewarm(unsigned observationsPerCycle, unsigned cycles) {
+	for (unsigned c = 1; c <= cycles; c++) {
+		const unsigned observations = c * observationsPerCycle;
+		if (observations > MAX_OBSERVATIONS) {
+			break;
+		}
+		for (unsigned detections = 0; detections <= observations; detections++) {
+			for (unsigned q = 0; q < quantiles.size(); q++) {
+				try {
+					getQuantile(observations, detections, q);
+				} catch (const std::exception&) {
+					// boost fails to invert some distributions; leave it for the lookup
+				}
+			}
+		}
+	}
+}
+
+double& BetaQuantileTable::getEntry(unsigned observations, unsigned detections, unsigned q) {
+	const size_t points = quantiles.size();
+	if (observations >= tableRows) {
+
+		/* grow at least geometrically, up to the maximum number of observations */
+		tableRows = min(max(observations + 1, 2 * tableRows), MAX_OBSERVATIONS + 1);
+		table.resize(countsIndex(tableRows, 0) * points, numeric_limits<double>::quiet_NaN());
+	}
+
+	return table.at(countsIndex(observations, detections) * points + q);
+}
+
+} /* namespace am2 */
+} /* namespace dart */
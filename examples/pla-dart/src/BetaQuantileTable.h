@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#ifndef BETAQUANTILETABLE_H_
+#define BETAQUANTILETABLE_H_
+
+#include <vector>
+
+namespace dart {
+namespace am2 {
+
+/**
+ * Memoized quantiles of the beta distributions of the environment
+ *
+ * The distributions come from the observation and detection counts of
+ * the environment monitor, which are small integers that repeat
+ * constantly. The quantiles are computed the first time a pair of counts
+ * is seen and kept in a triangular table indexed by the counts. Counts
+ * over MAX_OBSERVATIONS are not kept, to bound the size of the table.
+ */
+class BetaQuantileTable {
+public:
+	static const unsigned MAX_OBSERVATIONS = 1024;
+
+	/**
+	 * @param quantiles quantiles to compute for each distribution
+	 */
+	BetaQuantileTable(const std::vector<double>& quantiles);
+
+	/**
+	 * @param observations number of observations of a location
+	 * @param detections number of those observations that detected an object
+	 * @param q index of the quantile in those given to the constructor
+	 * @return the quantile of the distribution of the probability of
+	 * 	having an object at the location
+	 */
+	double getQuantile(unsigned observations, unsigned detections, unsigned q);
+
+	/**
+	 * Computes the quantiles for all the counts a location can have after
+	 * up to a number of cycles, each with the same number of observations
+	 *
+	 * Quantiles that cannot be computed are skipped, so that looking them
+	 * up fails as it would without prewarming.
+	 *
+	 * @param observationsPerCycle number of observations per cycle
+	 * @param cycles number of cycles
+	 */
+	void prewarm(unsigned observationsPerCycle, unsigned cycles);
+
+protected:
+	std::vector<double> quantiles;
+	std::vector<double> table; /**< quantiles for each pair of counts, NaN if not computed yet */
+	unsigned tableRows = 0; /**< number of observation counts in the table */
+
+	/**
+	 * @return the entry for a quantile of the counts, which must not exceed MAX_OBSERVATIONS
+	 */
+	double& getEntry(unsigned observations, unsigned detections, unsigned q);
+};
+
+} /* namespace am2 */
+} /* namespace dart */
+
+#endif /* BETAQUANTILETABLE_H_ */
@@ -139,6 +139,14 @@ void DartAdaptationManager::initialize(const Params& params, std::unique_ptr<pla
 			new EnvironmentMonitor);
 	pEnvTargetMonitor.reset(
 			new EnvironmentMonitor);
+	pThreatDTMC.reset();
+	pTargetDTMC.reset();
+
+	/* discretize the distributions the monitors will typically have */
+	const auto approx = params.adaptationManager.distributionApproximation;
+	const unsigned horizon = params.adaptationManager.horizon;
+	DartDTMCEnvironment::prewarmQuantiles(approx, params.longRangeSensor.threatObservationsPerCycle, horizon);
+	DartDTMCEnvironment::prewarmQuantiles(approx, params.longRangeSensor.targetObservationsPerCycle, horizon);
 
 	instantiateAdaptationMgr(params);
 
@@ -153,10 +161,15 @@ pladapt::TacticList DartAdaptationManager::decideAdaptation(
 	pEnvTargetMonitor->update(monitoringInfo.targetSensing);
 
 	/* build env model with information collected so far */
-	dart::sim::Route senseRoute(monitoringInfo.position, monitoringInfo.directionX, monitoringInfo.directionY, params.adaptationManager.horizon);
-	DartDTMCEnvironment threatDTMC(*pEnvThreatMonitor, senseRoute, params.adaptationManager.distributionApproximation);
-	DartDTMCEnvironment targetDTMC(*pEnvTargetMonitor, senseRoute, params.adaptationManager.distributionApproximation);
-	pladapt::EnvironmentDTMCPartitioned jointEnv = pladapt::EnvironmentDTMCPartitioned::createJointDTMC(threatDTMC, targetDTMC);
+	const dart::sim::Route& senseRoute = monitoringInfo.forwardCells;
+	if (pThreatDTMC) {
+		pThreatDTMC->update(*pEnvThreatMonitor, senseRoute);
+		pTargetDTMC->update(*pEnvTargetMonitor, senseRoute);
+	} else {
+		pThreatDTMC.reset(new DartDTMCEnvironment(*pEnvThreatMonitor, senseRoute, params.adaptationManager.distributionApproximation));
+		pTargetDTMC.reset(new DartDTMCEnvironment(*pEnvTargetMonitor, senseRoute, params.adaptationManager.distributionApproximation));
+	}
+	pladapt::EnvironmentDTMCPartitioned jointEnv = DartDTMCEnvironment::createJointDTMC(*pThreatDTMC, *pTargetDTMC);
 
 	/* make adaptation decision */
 	//adaptMgr->setDebug(monitoringInfo.position.x == 4);
@@ -33,6 +33,7 @@
 #include <pladapt/ConfigurationManager.h>
 #include "Parameters.h"
 #include "EnvironmentMonitor.h"
+#include "DartDTMCEnvironment.h"
 #include "DartUtilityFunction.h"
 #include "DartConfiguration.h"
 #include <vector>
@@ -64,6 +65,13 @@ struct DartMonitoringInfo {
 	int directionX; /**< -1, 0 or +1 to indicate the horizontal direction of travel */
 	int directionY; /**< -1, 0 or +1 to indicate the vertical direction of travel */
 
+	/**
+	 * Cells in the look-ahead horizon, starting at the position of the
+	 * team and going in its direction of travel, as given by
+	 * Simulator::getForwardCells()
+	 */
+	dart::sim::Route forwardCells;
+
 	unsigned formation;	/**< 0:loose, 1:tight. If the formation is changing, this is the formation it is changing FROM */
 	double ttcIncAlt; /**< time to complete altitude increase, 0 means not executing */
 	double ttcDecAlt; /**< time to complete altitude decrease, 0 means not executing */
@@ -161,6 +169,10 @@ protected:
 	std::unique_ptr<EnvironmentMonitor> pEnvThreatMonitor;
 	std::unique_ptr<EnvironmentMonitor> pEnvTargetMonitor;
 
+	/* environment models, kept across decisions to update them incrementally */
+	std::unique_ptr<DartDTMCEnvironment> pThreatDTMC;
+	std::unique_ptr<DartDTMCEnvironment> pTargetDTMC;
+
 public:
 
 	DartConfiguration convertToDiscreteConfiguration(const DartMonitoringInfo& info) const;
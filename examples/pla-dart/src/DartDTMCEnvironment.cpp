@@ -28,7 +28,11 @@
 
 #include "DartDTMCEnvironment.h"
 #include "DartSimpleEnvironment.h"
+#include "BetaQuantileTable.h"
+#include <pladapt/JointEnvironment.h>
 
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 
 using namespace std;
@@ -58,57 +62,143 @@ const DistributionApproximationParams ApproxParams[] = {
 		}
 };
 
+/**
+ * @return the memoized quantiles for an approximation
+ */
+BetaQuantileTable& getQuantileTable(DartDTMCEnvironment::DistributionApproximation approx) {
+	static BetaQuantileTable tables[] = {
+			BetaQuantileTable(ApproxParams[DartDTMCEnvironment::E_PT].quantiles),
+			BetaQuantileTable(ApproxParams[DartDTMCEnvironment::POINT].quantiles)
+	};
+	return tables[approx];
 }
 
-// node index calculation: root node + previous parts + idx
-#define nodeIndex(part, idx) (1 + ApproxParams[approx].points * (part - 1) + idx)
+/**
+ * @return joint environment with the threat and target values, in that order
+ */
+std::shared_ptr<JointEnvironment> createJointEnvironment(
+		std::shared_ptr<DartSimpleEnvironment> threat, std::shared_ptr<DartSimpleEnvironment> target) {
+	auto joint = std::make_shared<JointEnvironment>(2);
+	joint->setComponent(0, threat);
+	joint->setComponent(1, target);
+	return joint;
+}
+
+}
 
 DartDTMCEnvironment::DartDTMCEnvironment(const EnvironmentMonitor& envMonitor,
 		const dart::sim::Route& route, DistributionApproximation approx)
-	: EnvironmentDTMCPartitioned(1 + ApproxParams[approx].points * route.size())
+	: approx(approx), horizonCells(route.size())
 {
+	update(envMonitor, route);
+}
+
+void DartDTMCEnvironment::update(const EnvironmentMonitor& envMonitor, const dart::sim::Route& route) {
+	if (route.size() != horizonCells.size()) {
+		throw std::invalid_argument("the horizon of the environment model cannot change");
+	}
+	if (horizonCells.empty()) {
+		return;
+	}
 
 	/*
-	 * The environment has one root state, which is not used, and
-	 * three other states, one for each point in the
-	 * discretized distribution. Each state value is a vector that holds
-	 * the value for each point in space over the horizon for one of the
-	 * points in the discrete distribution.
-	 *
-	 * To model the independence of the distributions, each state in the
-	 * DTMC has transitions to all the other states according to the
-	 * probabilities of the distribution discretization.
-	 *
-	 * The value of the root state is never used if put in the part 0;
-	 * only the transitions out of it are used, so its value is set to some bogus value.
+	 * align the models from the previous horizon with the new one. Typically
+	 * the horizon has moved one cell forward, so that the models of all the
+	 * cells but the last one can be reused.
 	 */
-
-	/* assign root node to partition 0. It's value is never used */
-	setStateValue(0, std::make_shared<DartSimpleEnvironment>(0));
-	assignToPart(0, 0);
-
-	TransitionMatrix& tm = getTransitionMatrix();
+	const auto shift = std::find_if(horizonCells.begin(), horizonCells.end(),
+			[&route](const CellModel& model) {
+				return !model.values.empty() && model.cell == route[0];
+			});
+	if (shift != horizonCells.begin() && shift != horizonCells.end()) {
+		std::rotate(horizonCells.begin(), shift, horizonCells.end());
+	}
 
 	for (unsigned t = 1; t <= route.size(); t++) {
+		const SensorResult observed = envMonitor.getResult(route[t - 1]);
+		CellModel& model = horizonCells[t - 1];
+		const bool reusable = !model.values.empty() && model.cell == observed.cellPosition
+				&& model.observations == observed.observations
+				&& model.detections == observed.detections;
+		if (reusable) {
+			continue;
+		}
 
-		/* compute the three points for the distribution at this position */
-		auto betaDistrib = envMonitor.getBetaDistribution(route[t - 1]);
+		model.cell = observed.cellPosition;
+		model.observations = observed.observations;
+		model.detections = observed.detections;
+		model.values.clear();
+
+		/* get the three points for the distribution at this position */
+		auto& quantileTable = getQuantileTable(approx);
 		for (int q = 0; q < ApproxParams[approx].points; q++) {
-			unsigned index = nodeIndex(t, q);
-			double probOfObject = boost::math::quantile(betaDistrib, ApproxParams[approx].quantiles[q]);
-			setStateValue(index, std::make_shared<DartSimpleEnvironment>(probOfObject));
-			assignToPart(t, index);
+			double probOfObject = quantileTable.getQuantile(model.observations, model.detections, q);
+			model.values.push_back(std::make_shared<DartSimpleEnvironment>(probOfObject));
+		}
+
+	}
+}
+
+unsigned DartDTMCEnvironment::getPointsPerPart() const {
+	return ApproxParams[approx].points;
+}
+
+double DartDTMCEnvironment::getProbability(unsigned point) const {
+	return ApproxParams[approx].probabilities.at(point);
+}
+
+EnvironmentDTMCPartitioned DartDTMCEnvironment::createJointDTMC(
+		const DartDTMCEnvironment& threats, const DartDTMCEnvironment& targets) {
+	if (threats.getHorizon() != targets.getHorizon()) {
+		throw std::invalid_argument("the threat and target models must have the same horizon");
+	}
+
+	const unsigned horizon = threats.getHorizon();
+	const unsigned targetPoints = targets.getPointsPerPart();
+	const unsigned points = threats.getPointsPerPart() * targetPoints;
+	EnvironmentDTMCPartitioned joint(1 + points * horizon);
+
+	/*
+	 * The value of the root state is never used if put in the part 0;
+	 * only the transitions out of it are used, so its value is set to some bogus value.
+	 */
+	auto bogus = std::make_shared<DartSimpleEnvironment>(0);
+	joint.setStateValue(0, createJointEnvironment(bogus, bogus));
+	joint.assignToPart(0, 0);
+
+	// node index calculation: root node + previous parts + idx
+	auto nodeIndex = [points](unsigned part, unsigned idx) {
+		return 1 + points * (part - 1) + idx;
+	};
+
+	TransitionMatrix& tm = joint.getTransitionMatrix();
+	for (unsigned t = 1; t <= horizon; t++) {
+		for (unsigned q = 0; q < points; q++) {
+			const unsigned threatPoint = q / targetPoints;
+			const unsigned targetPoint = q % targetPoints;
+			const unsigned index = nodeIndex(t, q);
+			joint.setStateValue(index, createJointEnvironment(threats.getStateValue(t, threatPoint),
+					targets.getStateValue(t, targetPoint)));
+			joint.assignToPart(t, index);
 
 			// add transitions to the new node
+			const double probability = threats.getProbability(threatPoint) * targets.getProbability(targetPoint);
 			if (t == 1) {
-				tm(0, index) = ApproxParams[approx].probabilities[q]; // connect to root node
+				tm(0, index) = probability; // connect to root node
 			} else {
-				for (int r = 0; r < ApproxParams[approx].points; r++) {
-					tm(nodeIndex(t - 1, r), index) = ApproxParams[approx].probabilities[q];
+				for (unsigned r = 0; r < points; r++) {
+					tm(nodeIndex(t - 1, r), index) = probability;
 				}
 			}
 		}
 	}
+
+	return joint;
+}
+
+void DartDTMCEnvironment::prewarmQuantiles(DistributionApproximation approx,
+		unsigned observationsPerCycle, unsigned cycles) {
+	getQuantileTable(approx).prewarm(observationsPerCycle, cycles);
 }
 
 DartDTMCEnvironment::~DartDTMCEnvironment() {
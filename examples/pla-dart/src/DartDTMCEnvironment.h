@@ -31,11 +31,31 @@
 
 #include <pladapt/EnvironmentDTMCPartitioned.h>
 #include "EnvironmentMonitor.h"
+#include <memory>
+#include <vector>
 
 namespace dart {
 namespace am2 {
 
-class DartDTMCEnvironment: public pladapt::EnvironmentDTMCPartitioned {
+class DartSimpleEnvironment;
+
+/**
+ * Model of one component of the environment along the look-ahead horizon
+ *
+ * The model is a DTMC with a root state, and then one part for each cell
+ * in the horizon, with one state for each point of the discretized
+ * distribution of the cell. Since the distributions of the cells are
+ * independent, every state of a part transitions to each state of the
+ * next part with the probability of its point. Thus, only the state values
+ * and the probabilities of the points are kept, in O(points * horizon)
+ * space. This compact form is only used for the components; the joint
+ * DTMC given to the adaptation managers is dense (see createJointDTMC()).
+ *
+ * The structure of the DTMC only depends on the length of the horizon, so
+ * the model can be kept across decisions and updated as the horizon slides
+ * along the route, recomputing only the cells whose observations changed.
+ */
+class DartDTMCEnvironment {
 public:
 
 	/**
@@ -49,7 +69,91 @@ public:
 	DartDTMCEnvironment(const EnvironmentMonitor& envMonitor,
 			const dart::sim::Route& route,
 			DistributionApproximation approx = DistributionApproximation::E_PT);
+
+	/**
+	 * Updates the model for a new horizon
+	 *
+	 * The state values of cells that are still in the horizon and whose
+	 * observations did not change are reused.
+	 *
+	 * @param envMonitor monitor with the observations of the environment
+	 * @param route cells in the horizon, which must be as many as when
+	 * 	the model was created
+	 */
+	void update(const EnvironmentMonitor& envMonitor, const dart::sim::Route& route);
+
+	/**
+	 * Computes in advance the discretization of the distributions that
+	 * result from sensing every cell a number of times per cycle
+	 *
+	 * @param approx approximation whose quantiles are computed
+	 * @param observationsPerCycle number of observations of each cell per cycle
+	 * @param cycles number of cycles a cell is observed, usually the horizon
+	 */
+	static void prewarmQuantiles(DistributionApproximation approx,
+			unsigned observationsPerCycle, unsigned cycles);
+
+	/**
+	 * @return number of cells in the horizon, which are the parts after the root
+	 */
+	unsigned getHorizon() const {
+		return horizonCells.size();
+	}
+
+	/**
+	 * @return number of states in each part after the root
+	 */
+	unsigned getPointsPerPart() const;
+
+	/**
+	 * @return probability of transitioning to a state of a part from any
+	 * 	state of the previous part
+	 */
+	double getProbability(unsigned point) const;
+
+	/**
+	 * @param part part of the state, from 1 to the horizon
+	 * @param point point of the distribution the state corresponds to
+	 * @return value of the state
+	 */
+	const std::shared_ptr<DartSimpleEnvironment>& getStateValue(unsigned part, unsigned point) const {
+		return horizonCells[part - 1].values[point];
+	}
+
+	/**
+	 * Creates the joint DTMC of threats and targets used by the adaptation managers
+	 *
+	 * The adaptation managers take a pladapt::EnvironmentDTMCPartitioned,
+	 * so the joint DTMC has a dense transition matrix with
+	 * (1 + points * horizon)^2 entries, where points is the product of the
+	 * points per part of the components. It is built once per decision,
+	 * computing each transition as the product of those of the components,
+	 * without building dense matrices for the components.
+	 *
+	 * @param threats model of the threats
+	 * @param targets model of the targets, with the same horizon
+	 * @return joint DTMC, whose state values are joint environments with
+	 * 	the threat and target values, in that order
+	 */
+	static pladapt::EnvironmentDTMCPartitioned createJointDTMC(
+			const DartDTMCEnvironment& threats, const DartDTMCEnvironment& targets);
+
 	virtual ~DartDTMCEnvironment();
+
+protected:
+
+	/**
+	 * Observations of a cell in the horizon, and the state values computed from them
+	 */
+	struct CellModel {
+		dart::sim::Coordinate cell;
+		unsigned observations = 0;
+		unsigned detections = 0;
+		std::vector<std::shared_ptr<DartSimpleEnvironment>> values; /**< one for each point of the approximation */
+	};
+
+	DistributionApproximation approx;
+	std::vector<CellModel> horizonCells; /**< model for each cell in the horizon, in order */
 };
 
 } /* namespace am2 */
@@ -28,7 +28,7 @@
 
 #include "DartUtilityFunction.h"
 #include "DartConfiguration.h"
-#include "DartEnvironment.h"
+#include <pladapt/JointEnvironment.h>
 #include <algorithm>
 #include <iostream>
 #include <random>
@@ -47,11 +47,23 @@ std::default_random_engine randomGenerator;
 DartUtilityFunction::DartUtilityFunction(double targetDetectionRange, double detectionFormationFactor,
 		double threatRange, double destructionFormationFactor,
 		double finalReward,
-		bool deterministic)
+		bool deterministic,
+		unsigned altitudeLevels)
 	: targetDetectionRange(targetDetectionRange), detectionFormationFactor(detectionFormationFactor),
 		threatRange(threatRange), destructionFormationFactor(destructionFormationFactor),
 		finalReward(finalReward), deterministic(deterministic)
 {
+	/* the planner evaluates the utility of the same few configurations over and over */
+	for (unsigned altitude = 0; altitude < altitudeLevels; altitude++) {
+		for (auto formation : { DartConfiguration::Formation::LOOSE, DartConfiguration::Formation::TIGHT }) {
+			for (bool ecm : { false, true }) {
+				DartConfiguration config(altitude, formation, 0, 0, 0, 0, ecm);
+				detectionTable.push_back(getProbabilityOfDetection(config));
+				destructionTable.push_back(getProbabilityOfDestruction(config));
+			}
+		}
+	}
+
 	if (INJECTED_RMSE > 0) {
 		//randomGenerator.seed(RandomSeed::getNextSeed());
 		pDist.reset(new normal_distribution<>(0, INJECTED_RMSE));
@@ -67,9 +79,11 @@ double DartUtilityFunction::getAdditiveUtility(
 		const pladapt::Configuration& config, const pladapt::Environment& env,
 		int time) const {
     auto& dartConfig = dynamic_cast<const DartConfiguration&>(config);
-    auto dartEnv = DartEnvironment(dynamic_cast<const JointEnvironment&>(env));
+    auto& jointEnv = dynamic_cast<const JointEnvironment&>(env);
 
-	double probOfDetection = getProbabilityOfDetection(dartConfig);
+    const size_t index = getTableIndex(dartConfig);
+	double probOfDetection = (index < detectionTable.size())
+			? detectionTable[index] : getProbabilityOfDetection(dartConfig);
 
 	if (INJECTED_RMSE > 0) {
     	double error = pDist->operator ()(randomGenerator);
@@ -81,7 +95,8 @@ double DartUtilityFunction::getAdditiveUtility(
     	}
     }
 
-	double utility = dartEnv.getProbOfTarget() * probOfDetection;
+	// the components of the environment are the threats and the targets, in that order
+	double utility = jointEnv.getComponent(1).asDouble() * probOfDetection;
 
     return utility;
 }
@@ -94,10 +109,12 @@ double DartUtilityFunction::getMultiplicativeUtility(
 		int time) const {
 
 	auto& dartConfig = dynamic_cast<const DartConfiguration&>(config);
-    auto dartEnv = DartEnvironment(dynamic_cast<const JointEnvironment&>(env));
+    auto& jointEnv = dynamic_cast<const JointEnvironment&>(env);
 
-	double probOfDestruction = dartEnv.getProbOfThreat()
-			* getProbabilityOfDestruction(dartConfig);
+    const size_t index = getTableIndex(dartConfig);
+	double probOfDestruction = jointEnv.getComponent(0).asDouble()
+			* ((index < destructionTable.size())
+					? destructionTable[index] : getProbabilityOfDestruction(dartConfig));
 
     return 1 - probOfDestruction;
 }
@@ -144,6 +161,11 @@ double DartUtilityFunction::getProbabilityOfDestruction(const DartConfiguration&
 	return probOfDestruction;
 }
 
+size_t DartUtilityFunction::getTableIndex(const DartConfiguration& config) {
+	return (size_t(config.getAltitudeLevel()) * 2
+			+ (config.getFormation() == DartConfiguration::Formation::TIGHT)) * 2 + config.getEcm();
+}
+
 DartUtilityFunction::~DartUtilityFunction() {
 }
 
@@ -32,6 +32,7 @@
 #include <pladapt/UtilityFunction.h>
 #include "DartConfiguration.h"
 #include <memory>
+#include <vector>
 
 namespace dart {
 namespace am2 {
@@ -43,11 +44,14 @@ public:
 	 * @param threat this is used to compute the probability of being hit by the threat
 	 * @param targetSensor this is used to compute the probability of detecting a target
 	 * @param finalReward value for the final reward (obtained at the end of the horizon)
+	 * @param altitudeLevels if not 0, the probabilities of detection and destruction
+	 * 	are precomputed for the configurations with altitude below this
 	 */
 	DartUtilityFunction(double targetDetectionRange, double detectionFormationFactor,
 			double threatRange, double destructionFormationFactor,
 			double finalReward,
-			bool deterministic);
+			bool deterministic,
+			unsigned altitudeLevels = 0);
 	virtual double getAdditiveUtility(const pladapt::Configuration& config, const pladapt::Environment& env, int time) const;
     virtual double getMultiplicativeUtility(const pladapt::Configuration& config, const pladapt::Environment& env, int time) const;
     virtual double getFinalReward(const pladapt::Configuration& config, const pladapt::Environment& env, int time) const;
@@ -61,8 +65,18 @@ protected:
     const double finalReward;
     const bool deterministic;
 
+    /* probabilities for each altitude, formation and ECM setting */
+    std::vector<double> detectionTable;
+    std::vector<double> destructionTable;
+
     double getProbabilityOfDetection(const DartConfiguration& config) const;
     double getProbabilityOfDestruction(const DartConfiguration& config) const;
+
+    /**
+     * @return index of the configuration in the tables, which is past their
+     * 	end if the configuration was not precomputed
+     */
+    static size_t getTableIndex(const DartConfiguration& config);
 };
 
 } /* namespace am2 */
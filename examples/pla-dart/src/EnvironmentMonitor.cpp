@@ -66,20 +66,67 @@ EnvironmentMonitor::~EnvironmentMonitor() {
 //	}
 //}
 
-void EnvironmentMonitor::processSensorReadings(const dart::sim::Route& route, std::vector<bool> sensorReadings) {
+void EnvironmentMonitor::cover(dart::sim::Coordinate low, dart::sim::Coordinate high) {
+	if (!counts.empty()) {
+		const dart::sim::Coordinate end(origin.x + size.x, origin.y + size.y);
+		if (low.x >= origin.x && low.y >= origin.y && high.x < end.x && high.y < end.y) {
+			return;
+		}
+
+		/* keep the current grid, and at least double the dimensions that grow */
+		low.x = (low.x < origin.x) ? min(low.x, origin.x - size.x) : origin.x;
+		low.y = (low.y < origin.y) ? min(low.y, origin.y - size.y) : origin.y;
+		high.x = (high.x >= end.x) ? max(high.x, end.x + size.x - 1) : end.x - 1;
+		high.y = (high.y >= end.y) ? max(high.y, end.y + size.y - 1) : end.y - 1;
+	}
+
+	const dart::sim::Coordinate newSize(high.x - low.x + 1, high.y - low.y + 1);
+	if (counts.empty()) {
+
+		// this reuses the allocation left by clear()
+		counts.assign(size_t(newSize.x) * newSize.y, CellCounts{0, 0});
+	} else {
+		std::vector<CellCounts> newCounts(size_t(newSize.x) * newSize.y, CellCounts{0, 0});
+		for (int row = 0; row < size.y; row++) {
+			copy_n(counts.begin() + size_t(row) * size.x, size.x,
+					newCounts.begin() + size_t(origin.y - low.y + row) * newSize.x + (origin.x - low.x));
+		}
+		counts.swap(newCounts);
+	}
+	origin = low;
+	size = newSize;
+}
+
+void EnvironmentMonitor::cover(const dart::sim::Route& route) {
+	if (route.empty()) {
+		return;
+	}
+	dart::sim::Coordinate low = route.front();
+	dart::sim::Coordinate high = low;
+	for (const auto& pos : route) {
+		low.x = min(low.x, pos.x);
+		low.y = min(low.y, pos.y);
+		high.x = max(high.x, pos.x);
+		high.y = max(high.y, pos.y);
+	}
+	cover(low, high);
+}
+
+const EnvironmentMonitor::CellCounts* EnvironmentMonitor::find(const dart::sim::Coordinate& location) const {
+	if (location.x < origin.x || location.y < origin.y
+			|| location.x >= origin.x + size.x || location.y >= origin.y + size.y) {
+		return nullptr;
+	}
+	return &counts[size_t(location.y - origin.y) * size.x + (location.x - origin.x)];
+}
+
+void EnvironmentMonitor::processSensorReadings(const dart::sim::Route& route, const std::vector<bool>& sensorReadings) {
+	cover(route);
 	dart::sim::Route::const_iterator posIt = route.begin();
 	for (bool reading : sensorReadings) {
-		const auto& pos = *posIt;
-		observations[pos]++;
-		if (reading) {
-			detections[pos]++;
-		} else {
-
-			/* set detections to 0 if it's not set */
-			if (detections.find(pos) == detections.end()) {
-				detections[pos] = 0;
-			}
-		}
+		auto& cell = at(*posIt);
+		cell.observations++;
+		cell.detections += reading;
 		posIt++;
 	}
 
@@ -90,55 +137,64 @@ void EnvironmentMonitor::processSensorReadings(const dart::sim::Route& route, st
 	 * one true and one false, and don't accumulate them.
 	 */
 	while (posIt != route.end()) {
-		const auto& pos = *posIt;
-		detections[pos] = 1;
-		observations[pos] = 2;
+		at(*posIt) = CellCounts{2, 1};
 		posIt++;
 	}
 }
 
 boost::math::beta_distribution<> EnvironmentMonitor::getBetaDistribution(const dart::sim::Coordinate& location) const {
+	const CellCounts* cell = find(location);
+	if (cell) {
+		return getBetaDistribution(cell->observations, cell->detections);
+	}
+	return getBetaDistribution(0, 0);
+}
+
+boost::math::beta_distribution<> EnvironmentMonitor::getBetaDistribution(unsigned observations, unsigned detections) {
 	double alpha = 1e-300;
 	double beta = 1.0;
-	if (observations.find(location) != observations.end()) {
-		auto dets = detections.at(location);
-		if (dets > 0) {
-			alpha = dets;
+	if (observations > 0) {
+		if (detections > 0) {
+			alpha = detections;
 		}
-		beta = max(double(observations.at(location) - dets), 1e-300);
+		beta = max(double(observations) - detections, 1e-300);
 	}
 	return beta_distribution<>(alpha, beta);
 }
 
 void EnvironmentMonitor::update(const SensorResults& sensorResults) {
 	for (const auto& sensorResult: sensorResults) {
-		observations[sensorResult.cellPosition] += sensorResult.observations;
-		detections[sensorResult.cellPosition] += sensorResult.detections;
+		const auto& pos = sensorResult.cellPosition;
+		cover(pos, pos);
+		auto& cell = at(pos);
+		cell.observations += sensorResult.observations;
+		cell.detections += sensorResult.detections;
 	}
 }
 
 SensorResults dart::am2::EnvironmentMonitor::getResults(
 		const dart::sim::Route& route) const {
 	SensorResults results;
-	for (const auto& cell : route) {
-		SensorResult result;
-		result.cellPosition = cell;
-		const auto observationPos = observations.find(cell);
-		if (observationPos != observations.end()) {
-			result.observations = observationPos->second;
-		}
-		const auto detectionPos = detections.find(cell);
-		if (detectionPos != detections.end()) {
-			result.detections = detectionPos->second;
-		}
-		results.push_back(result);
+	results.reserve(route.size());
+	for (const auto& pos : route) {
+		results.push_back(getResult(pos));
 	}
 	return results;
 }
 
+SensorResult EnvironmentMonitor::getResult(const dart::sim::Coordinate& location) const {
+	const CellCounts* cell = find(location);
+	if (cell) {
+		return { location, unsigned(cell->observations), unsigned(cell->detections) };
+	}
+	return { location, 0, 0 };
+}
+
 void dart::am2::EnvironmentMonitor::clear() {
-	observations.clear();
-	detections.clear();
+	/* keep the allocation, since monitors are typically cleared every cycle */
+	counts.clear();
+	origin = dart::sim::Coordinate();
+	size = dart::sim::Coordinate();
 }
 
 } /* namespace am2 */
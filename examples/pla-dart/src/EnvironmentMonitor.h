@@ -30,8 +30,8 @@
 #define ENVIRONMENTMONITOR_H_
 
 #include <dartsim/Route.h>
-#include <map>
 #include <memory>
+#include <vector>
 #include <boost/math/distributions/beta.hpp>
 
 namespace dart {
@@ -49,6 +49,11 @@ using SensorResults = std::vector<SensorResult>;
 
 /**
  * Monitors the environment by getting observations through a sensor
+ *
+ * The counts are kept in a dense row-major grid covering the bounding box
+ * of the cells observed so far, which grows as needed. In a map with a
+ * single row, this is indexed by the position along the route, and the
+ * cells of the look-ahead horizon are contiguous.
  */
 class EnvironmentMonitor {
 public:
@@ -64,7 +69,7 @@ public:
 //	 */
 //	void sense(const RealEnvironment& realEnvironment, unsigned numOfObservations, const Route& route);
 
-	void processSensorReadings(const dart::sim::Route& route, std::vector<bool> sensorReadings);
+	void processSensorReadings(const dart::sim::Route& route, const std::vector<bool>& sensorReadings);
 
 
 	/**
@@ -83,6 +88,11 @@ public:
 	 */
 	SensorResults getResults(const dart::sim::Route& route) const;
 
+	/**
+	 * Return the sensor results for a given location
+	 */
+	SensorResult getResult(const dart::sim::Coordinate& location) const;
+
 	/**
 	 * Remove all previous observations
 	 */
@@ -96,11 +106,53 @@ public:
 	 */
 	boost::math::beta_distribution<> getBetaDistribution(const dart::sim::Coordinate& location) const;
 
+	/**
+	 * Returns the probability distribution of having an object at a location
+	 * given its counts
+	 *
+	 * @param observations number of observations taken in the location
+	 * @param detections number of times an object was detected in the location
+	 * @return distribution
+	 */
+	static boost::math::beta_distribution<> getBetaDistribution(unsigned observations, unsigned detections);
+
 protected:
 
-	typedef std::map<dart::sim::Coordinate, int> MapCount;
-	MapCount observations; /**< number of observations taken in each location */
-	MapCount detections; /**< number of times an object was detected in each location */
+	/**
+	 * Counts for one location, kept together because they are always used together
+	 *
+	 * A location with no observations is considered not to have been sensed.
+	 */
+	struct CellCounts {
+		int observations; /**< number of observations taken in the location */
+		int detections; /**< number of times an object was detected in the location */
+	};
+
+	dart::sim::Coordinate origin; /**< lowest corner of the grid */
+	dart::sim::Coordinate size; /**< width and height of the grid */
+	std::vector<CellCounts> counts; /**< counts in row-major order */
+
+	/**
+	 * Grows the grid, if needed, so that it includes the rectangle between two corners
+	 */
+	void cover(dart::sim::Coordinate low, dart::sim::Coordinate high);
+
+	/**
+	 * Grows the grid, if needed, so that it includes all the points of the route
+	 */
+	void cover(const dart::sim::Route& route);
+
+	/**
+	 * @return the counts of a location, which must be inside the grid
+	 */
+	CellCounts& at(const dart::sim::Coordinate& location) {
+		return counts[size_t(location.y - origin.y) * size.x + (location.x - origin.x)];
+	}
+
+	/**
+	 * @return the counts of a location, or nullptr if it is outside of the grid
+	 */
+	const CellCounts* find(const dart::sim::Coordinate& location) const;
 };
 
 } /* namespace am2 */
@@ -265,7 +265,8 @@ int main(int argc, char** argv) {
 							adaptParams.simulationParams.threat.threatRange,
 							adaptParams.simulationParams.threat.destructionFormationFactor,
 							adaptParams.adaptationManager.finalReward,
-							adaptParams.simulationParams.optimalityTest)));
+							adaptParams.simulationParams.optimalityTest,
+							adaptParams.simulationParams.altitudeLevels)));
 
 	if (adaptParams.simulationParams.optimalityTest && !adaptMgr.supportsStrategy()) {
 		throw std::invalid_argument("selected adaptation manager does not support full strategies");
@@ -275,12 +276,14 @@ int main(int argc, char** argv) {
 	EnvironmentMonitor envThreatMonitor;
 	EnvironmentMonitor envTargetMonitor;
 
+	// reused across cycles so that its cells are not allocated again
+	DartMonitoringInfo monitoringInfo;
+
 	while (!sim.finished()) {
 		auto simState = sim.getState();
 
-		cout << "current position: " << simState.position << endl;
+		cout << "current position: " << simState.position << '\n';
 
-		DartMonitoringInfo monitoringInfo;
 		monitoringInfo.position.x = simState.position.x;
 		monitoringInfo.position.y = simState.position.y;
 		monitoringInfo.altitudeLevel = simState.config.altitudeLevel - 1;
@@ -300,7 +303,8 @@ int main(int argc, char** argv) {
 		monitoringInfo.ecm = simState.config.ecm;
 
 		/* monitor environment */
-		dart::sim::Route senseRoute(monitoringInfo.position, monitoringInfo.directionX, monitoringInfo.directionY, adaptParams.adaptationManager.horizon);
+		sim.getForwardCells(adaptParams.adaptationManager.horizon, monitoringInfo.forwardCells);
+		const dart::sim::Route& senseRoute = monitoringInfo.forwardCells;
 #if !RANDOMSEED_COMPATIBILITY
 
 		// unless compatibility is required, this is preferred (more efficient)
@@ -0,0 +1,137 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+
+#include <dartsim/Simulator.h>
+#include <functional>
+#include <vector>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Results of a batch of missions
+ */
+struct BatchResults {
+
+	/**
+	 * Seed used for each mission
+	 */
+	std::vector<int> seeds;
+
+	/**
+	 * Results of each mission, in the same order as seeds
+	 */
+	std::vector<SimulationResults> missions;
+
+	/**
+	 * Number of missions in which the team was destroyed
+	 */
+	unsigned destroyed = 0;
+
+	/**
+	 * Number of missions completed successfully
+	 */
+	unsigned missionSuccesses = 0;
+
+	/**
+	 * Average number of targets detected per mission
+	 */
+	double targetsDetectedAvg = 0.0;
+
+	/**
+	 * Average of the decision time averages of the missions
+	 */
+	double decisionTimeAvg = 0.0;
+
+	/**
+	 * Median, 90th and 99th percentiles, and maximum of the decision times
+	 * of all the steps of all the missions
+	 */
+	double decisionTimeP50 = 0.0;
+	double decisionTimeP90 = 0.0;
+	double decisionTimeP99 = 0.0;
+	double decisionTimeMax = 0.0;
+};
+
+/**
+ * Runs a batch of missions with different seeds within one process
+ *
+ * Each mission gets its own simulator instance, and the missions are run
+ * concurrently in a pool of threads.
+ */
+class BatchRunner {
+public:
+
+	/**
+	 * Function that plays the role of the adaptation manager in a mission
+	 *
+	 * It must run the mission controlling the simulator until it finishes.
+	 * Since it is called concurrently from several threads, it must not
+	 * modify state shared across missions.
+	 */
+	using MissionFunction = std::function<void(Simulator& sim)>;
+
+	/**
+	 * @param simParams simulation parameters used for all the missions. If
+	 * 	they have an event sink, it receives the events of all the missions.
+	 * @param scenarioParams scenario parameters used for all the missions
+	 * 	(the seed is replaced by the seed of each mission)
+	 * @param mission function that runs each mission
+	 */
+	BatchRunner(const SimulationParams& simParams,
+			const ScenarioParams& scenarioParams, MissionFunction mission);
+
+	/**
+	 * Runs the batch of missions
+	 *
+	 * @param firstSeed seed of the first mission. The rest of the missions
+	 * 	use consecutive seeds.
+	 * @param numOfMissions number of missions to run
+	 * @param numOfThreads number of threads to use, 0 for one per core
+	 * @return results of the missions
+	 */
+	BatchResults run(int firstSeed, unsigned numOfMissions, unsigned numOfThreads = 0);
+
+	virtual ~BatchRunner();
+
+protected:
+	SimulationParams simParams;
+	ScenarioParams scenarioParams;
+	MissionFunction mission;
+
+	/**
+	 * @param decisionTimes histogram to which the decision times of the
+	 * 	mission are added
+	 */
+	SimulationResults runMission(int seed, LatencyHistogram& decisionTimes);
+};
+
+} /* namespace sim */
+} /* namespace dart */
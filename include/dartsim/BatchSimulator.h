@@ -0,0 +1,197 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+
+#include <dartsim/Simulator.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dart {
+namespace sim {
+
+class RealEnvironment;
+class RouteGeometry;
+class Sensor;
+class Threat;
+class TargetSensor;
+
+/**
+ * Simulates a batch of independent missions in lockstep
+ *
+ * The state of the missions is kept in structure-of-arrays layout, so that
+ * each phase of a step is a loop over all the missions. Mission m uses the
+ * scenario of seed firstSeed + m, and given the same tactics, its results
+ * are the same as those of a simulator created with
+ * Simulator::createInstance() for that seed.
+ *
+ * Unlike Simulator, it does not report events, record the trajectory, or
+ * collect decision times.
+ */
+class BatchSimulator {
+public:
+
+	/**
+	 * @param simParams simulation parameters used for all the missions
+	 * @param scenarioParams scenario parameters used for all the missions
+	 * 	(the seed is replaced by the seed of each mission)
+	 * @param firstSeed seed of the first mission. The rest of the missions
+	 * 	use consecutive seeds.
+	 * @param numOfMissions number of missions
+	 * @throws std::invalid_argument if the parameters are not valid
+	 */
+	BatchSimulator(const SimulationParams& simParams,
+			const ScenarioParams& scenarioParams,
+			int firstSeed, unsigned numOfMissions);
+
+	/**
+	 * @return number of missions in the batch
+	 */
+	unsigned size() const;
+
+	/**
+	 * @return true if all the missions have finished
+	 */
+	bool finished() const;
+
+	/**
+	 * @return true if the mission has finished
+	 */
+	bool finished(unsigned mission) const;
+
+	/**
+	 * Return state of the team of a mission
+	 *
+	 * @param mission index of the mission
+	 * @param state where the state of the team is stored
+	 */
+	void getState(unsigned mission, TeamState& state) const;
+
+	/**
+	 * Read the forward-looking threat sensor of a mission
+	 *
+	 * This is the same as Simulator::readForwardThreatSensor(cells, sensed)
+	 *
+	 * @return number of cells sensed
+	 */
+	unsigned readForwardThreatSensor(unsigned mission, unsigned cells, bool* sensed);
+
+	/**
+	 * Read the forward-looking target sensor of a mission
+	 *
+	 * This is the same as Simulator::readForwardTargetSensor(cells, sensed)
+	 *
+	 * @return number of cells sensed
+	 */
+	unsigned readForwardTargetSensor(unsigned mission, unsigned cells, bool* sensed);
+
+	/**
+	 * Executes one simulation step in all the missions that have not
+	 * finished
+	 *
+	 * @param tactics tactics to execute in each mission, with one entry per
+	 * 	mission
+	 * @throws std::invalid_argument if the size of tactics is not the
+	 * 	number of missions
+	 */
+	void step(const std::vector<TacticSet>& tactics);
+
+	/**
+	 * Get results of a mission
+	 *
+	 * The decision time statistics are always NaN, as in the results of a
+	 * Simulator that has not recorded any decision time.
+	 *
+	 * @param mission index of the mission
+	 * @return simulation results
+	 */
+	SimulationResults getResults(unsigned mission) const;
+
+	virtual ~BatchSimulator();
+
+protected:
+	SimulationParams params;
+	unsigned numOfMissions;
+	unsigned missionSuccessThreshold;
+
+	/* route shared by all the missions, and its directions and forward rays */
+	std::vector<int> routeX;
+	std::vector<int> routeY;
+	std::shared_ptr<const RouteGeometry> routeGeometry;
+
+	std::vector<std::shared_ptr<const RealEnvironment>> threatEnvs;
+	std::vector<std::shared_ptr<const RealEnvironment>> targetEnvs;
+	std::vector<std::unique_ptr<Sensor>> fwdThreatSensors;
+	std::vector<std::unique_ptr<Sensor>> fwdTargetSensors;
+
+	/* state of the missions */
+	std::vector<uint32_t> routeIndex;
+	std::vector<int> positionX;
+	std::vector<int> positionY;
+	std::vector<unsigned> altitudeLevel;
+	std::vector<uint8_t> tightFormation;
+	std::vector<uint8_t> ecm;
+	std::vector<unsigned> ttcIncAlt;
+	std::vector<unsigned> ttcDecAlt;
+	std::vector<unsigned> ttcIncAlt2;
+	std::vector<unsigned> ttcDecAlt2;
+	std::vector<uint8_t> destroyed;
+	std::vector<unsigned> targetsDetected;
+
+	/* random streams of threats and the downward-looking sensor */
+	std::vector<uint64_t> threatStreamKeys;
+	std::vector<uint64_t> threatStreamCounters;
+	std::vector<uint64_t> targetStreamKeys;
+	std::vector<uint64_t> targetStreamCounters;
+
+	/* scratch arrays used in each step */
+	std::vector<uint8_t> active;
+	std::vector<uint8_t> objectPresent;
+	std::vector<uint64_t> threshold;
+
+	/*
+	 * The probabilities of destruction and detection only depend on the
+	 * altitude, formation and ECM, so they are precomputed as thresholds
+	 * for raw random numbers for the altitudes in [0, tableAltitudes).
+	 * Other altitudes use the formulas directly.
+	 */
+	std::shared_ptr<Threat> pThreat;
+	std::shared_ptr<TargetSensor> pTargetSensor;
+	unsigned tableAltitudes;
+	std::vector<uint64_t> destructionThresholds;
+	std::vector<uint64_t> detectionThresholds;
+
+	TeamConfiguration getConfiguration(unsigned mission) const;
+	size_t getTableIndex(unsigned mission) const;
+	unsigned readForwardSensor(unsigned mission, const RealEnvironment& environment,
+			Sensor& sensor, unsigned cells, bool* sensed);
+};
+
+} /* namespace sim */
+} /* namespace dart */
@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+
+#include <dartsim/Route.h>
+#include <dartsim/Tactic.h>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Receiver of the events of a simulation
+ *
+ * The simulator reports the tactics it executes, the targets it detects, and
+ * the destruction of the team. Sinks are not thread-safe, so a sink must not
+ * be used by simulators running in different threads.
+ */
+class EventSink {
+public:
+	virtual void tacticExecuted(const Coordinate& position, Tactic tactic) = 0;
+	virtual void targetDetected(const Coordinate& position) = 0;
+	virtual void teamDestroyed(const Coordinate& position) = 0;
+
+	/**
+	 * Writes any buffered events
+	 */
+	virtual void flush();
+
+	virtual ~EventSink();
+};
+
+/**
+ * Sink that discards all the events
+ */
+class NullEventSink : public EventSink {
+public:
+	void tacticExecuted(const Coordinate& position, Tactic tactic) override;
+	void targetDetected(const Coordinate& position) override;
+	void teamDestroyed(const Coordinate& position) override;
+};
+
+/**
+ * Base class for sinks that write the events to a stream through a buffer
+ */
+class StreamEventSink : public EventSink {
+public:
+	static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+	void flush() override;
+	virtual ~StreamEventSink();
+
+protected:
+
+	/**
+	 * @param out stream where the events are written
+	 * @param bufferSize bytes buffered before writing them to the stream.
+	 * 	If it is 0, each event is written to the stream as soon as it
+	 * 	happens, although the stream may still buffer it.
+	 */
+	StreamEventSink(std::ostream& out, size_t bufferSize);
+
+	/**
+	 * @param path file where the events are written
+	 * @param bufferSize bytes buffered before writing them to the file
+	 * @throws std::runtime_error if the file cannot be opened
+	 */
+	StreamEventSink(const std::string& path, size_t bufferSize);
+
+	std::string buffer;
+
+	/**
+	 * Must be called after appending an event to the buffer
+	 */
+	void eventAdded();
+
+private:
+	std::unique_ptr<std::ofstream> pFile;
+	std::ostream& out;
+	const size_t bufferSize;
+
+	void writeBuffer();
+};
+
+/**
+ * Sink that writes the events as lines of text
+ */
+class TextEventSink : public StreamEventSink {
+public:
+	TextEventSink(std::ostream& out, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+	TextEventSink(const std::string& path, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+	void tacticExecuted(const Coordinate& position, Tactic tactic) override;
+	void targetDetected(const Coordinate& position) override;
+	void teamDestroyed(const Coordinate& position) override;
+};
+
+/**
+ * Sink that writes the events as fixed-size binary records
+ *
+ * Each record has 10 bytes: uint8 event type, uint8 tactic, int32 x,
+ * int32 y, with the integers in little-endian order. The tactic is only
+ * meaningful for TACTIC_EXECUTED events, and it is the value of the Tactic.
+ */
+class BinaryEventSink : public StreamEventSink {
+public:
+	enum EventType { TACTIC_EXECUTED = 0, TARGET_DETECTED = 1, TEAM_DESTROYED = 2 };
+
+	static const size_t RECORD_SIZE = 10;
+
+	BinaryEventSink(std::ostream& out, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+	BinaryEventSink(const std::string& path, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+	void tacticExecuted(const Coordinate& position, Tactic tactic) override;
+	void targetDetected(const Coordinate& position) override;
+	void teamDestroyed(const Coordinate& position) override;
+
+private:
+	void addRecord(EventType type, unsigned tactic, const Coordinate& position);
+};
+
+} /* namespace sim */
+} /* namespace dart */
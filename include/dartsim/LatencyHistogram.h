@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Histogram of latencies in nanoseconds with bounded relative error
+ *
+ * As in HdrHistogram, values are counted in buckets that are linear within
+ * each power of two, with 2^SUB_BUCKET_BITS buckets per power of two, so
+ * that the quantiles are reported with a relative error below
+ * 2^-SUB_BUCKET_BITS using a fixed amount of memory. Values of 2^MAX_EXPONENT
+ * nanoseconds (about 18 minutes) or more are counted in the last bucket.
+ *
+ * Recording only does relaxed atomic increments, so a histogram can be
+ * recorded by one thread while others read it, and several threads can
+ * record the same histogram without locks. Copying a histogram takes a
+ * snapshot of it, and histograms can be merged to aggregate them.
+ */
+class LatencyHistogram {
+public:
+	static const unsigned SUB_BUCKET_BITS = 4;
+	static const unsigned MAX_EXPONENT = 40;
+	static const unsigned NUM_BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+	LatencyHistogram();
+	LatencyHistogram(const LatencyHistogram& histogram);
+	LatencyHistogram& operator=(const LatencyHistogram& histogram);
+
+	/**
+	 * Records a latency
+	 *
+	 * @param nanoseconds latency
+	 */
+	void record(uint64_t nanoseconds) {
+		buckets[getBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+		uint64_t currentMax = maxLatency.load(std::memory_order_relaxed);
+		while (nanoseconds > currentMax
+				&& !maxLatency.compare_exchange_weak(currentMax, nanoseconds, std::memory_order_relaxed)) {
+		}
+	}
+
+	/**
+	 * Adds the counts of another histogram to this one
+	 */
+	void merge(const LatencyHistogram& histogram);
+
+	/**
+	 * Removes all the recorded latencies
+	 */
+	void reset();
+
+	uint64_t getCount() const;
+
+	/**
+	 * @return mean latency in nanoseconds, or 0 if there are no latencies
+	 */
+	double getMean() const;
+
+	/**
+	 * @return maximum latency in nanoseconds
+	 */
+	uint64_t getMax() const;
+
+	/**
+	 * @param quantile quantile in [0, 1] (e.g., 0.99 for the 99th percentile)
+	 * @return the highest latency of the bucket that holds the quantile,
+	 * 	which is within the relative error of the actual quantile, or 0 if
+	 * 	there are no latencies
+	 */
+	uint64_t getQuantile(double quantile) const;
+
+	static unsigned getBucket(uint64_t nanoseconds);
+
+	/**
+	 * @return the highest latency counted in a bucket
+	 */
+	static uint64_t getBucketLimit(unsigned bucket);
+
+private:
+	std::atomic<uint64_t> buckets[NUM_BUCKETS];
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> sum;
+	std::atomic<uint64_t> maxLatency;
+
+	void copy(const LatencyHistogram& histogram);
+};
+
+/**
+ * Measures the time until it is destroyed, and records it in a histogram
+ *
+ * If the histogram is null, it does not even read the clock.
+ */
+class LatencyTimer {
+public:
+	explicit LatencyTimer(LatencyHistogram* pHistogram) : pHistogram(pHistogram) {
+		if (pHistogram) {
+			start = std::chrono::steady_clock::now();
+		}
+	}
+
+	~LatencyTimer() {
+		if (pHistogram) {
+			pHistogram->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - start).count());
+		}
+	}
+
+	LatencyTimer(const LatencyTimer&) = delete;
+	LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+private:
+	LatencyHistogram* pHistogram;
+	std::chrono::steady_clock::time_point start;
+};
+
+} /* namespace sim */
+} /* namespace dart */
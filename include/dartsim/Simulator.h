@@ -28,8 +28,12 @@
 
 #pragma once
 
+#include <dartsim/EventSink.h>
+#include <dartsim/LatencyHistogram.h>
 #include <dartsim/Route.h>
+#include <dartsim/Tactic.h>
 #include <dartsim/TeamConfiguration.h>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
@@ -160,6 +164,88 @@ struct SimulationParams {
 	 * Parameters of threats
 	 */
 	ThreatParams threat;
+
+	/**
+	 * Sink that receives the events of the simulation, such as the execution
+	 * of tactics.
+	 *
+	 * If it is nullptr, the events are discarded, so that the simulation
+	 * does no I/O.
+	 */
+	std::shared_ptr<EventSink> eventSink;
+
+	/**
+	 * Whether to record the trajectory of the team, which is only needed
+	 * for getScreenOutput()
+	 */
+	bool recordTrajectory = true;
+
+	/**
+	 * Whether to measure the latency of the phases of the simulation,
+	 * which are reported by Simulator::getMetrics()
+	 */
+	bool collectMetrics = false;
+};
+
+/**
+ * Parameters used to generate the scenario of a mission
+ *
+ * Unlike SimulationParams, these are not known by the adaptation manager
+ */
+struct ScenarioParams {
+
+	/**
+	 * Number of threats randomly placed in the map
+	 */
+	unsigned numThreats = 6;
+
+	/**
+	 * Number of targets randomly placed in the map
+	 */
+	unsigned numTargets = 4;
+
+	/**
+	 * Fraction of the cells of the map with threats
+	 *
+	 * If it is greater than 0, it is used instead of numThreats.
+	 */
+	double threatDensity = 0.0;
+
+	/**
+	 * Fraction of the cells of the map with targets
+	 *
+	 * If it is greater than 0, it is used instead of numTargets.
+	 */
+	double targetDensity = 0.0;
+
+	/**
+	 * Whether to store the environment in sparse maps instead of bitsets
+	 */
+	bool sparseEnvironment = false;
+
+	/**
+	 * Whether the random number generation must be seeded with seed.
+	 *
+	 * If this is false, a random seed is used.
+	 */
+	bool seeded = false;
+
+	/**
+	 * Seed for the master random generator
+	 */
+	int seed = 0;
+
+	/**
+	 * Scenario file written by writeScenario() to load the scenario from
+	 *
+	 * If it is not empty, the environments and the route are those in the
+	 * file instead of being generated, and the map size and number of
+	 * threats and targets are also taken from the file. Unless seeded is
+	 * true, the seed with which the scenario was generated is used for the
+	 * rest of the simulation, so that it runs exactly as it would have
+	 * without the file.
+	 */
+	std::string scenarioFile;
 };
 
 /**
@@ -201,6 +287,15 @@ struct SimulationResults {
 	 * Variance of decision time (if reported)
 	 */
 	double decisionTimeVar;
+
+	/**
+	 * Median, 90th and 99th percentiles, and maximum of decision time (if
+	 * reported), within the relative error of LatencyHistogram
+	 */
+	double decisionTimeP50;
+	double decisionTimeP90;
+	double decisionTimeP99;
+	double decisionTimeMax;
 };
 
 
@@ -238,6 +333,78 @@ struct TeamState {
 	TeamConfiguration config;
 };
 
+/**
+ * Latencies of the phases of the simulation, in nanoseconds
+ */
+struct SimulatorMetrics {
+	LatencyHistogram sensing; /**< reading the forward-looking sensors */
+	LatencyHistogram tactics; /**< executing the tactics of a step */
+	LatencyHistogram threats; /**< simulating the threats in a step */
+	LatencyHistogram targets; /**< simulating target detection in a step */
+};
+
+/**
+ * Several observations of the cells in front of the team
+ *
+ * The observations are stored as a bit matrix with a row of wordsPerCell
+ * words for each cell. Observation j of cell i is bit (j % 64) of
+ * bits[i * wordsPerCell + j / 64].
+ *
+ * Reusing the same object for several reads avoids allocating memory once it
+ * has grown enough for the largest read.
+ */
+struct SensorReadings {
+
+	/**
+	 * Maximum number of observations of each cell that can be read at once
+	 */
+	static const unsigned MAX_OBSERVATIONS = 65536;
+
+	/**
+	 * Number of cells sensed, which is less than requested if the cells
+	 * ahead of the team go out of the map
+	 */
+	unsigned cells = 0;
+
+	/**
+	 * Number of observations of each cell
+	 */
+	unsigned observations = 0;
+
+	/**
+	 * Number of words of each row of the bit matrix
+	 */
+	unsigned wordsPerCell = 0;
+
+	/**
+	 * Bit matrix of observations
+	 */
+	std::vector<uint64_t> bits;
+
+	/**
+	 * Number of positive observations of each cell
+	 */
+	std::vector<unsigned> counts;
+
+	/**
+	 * @return the observation of a cell
+	 */
+	bool get(unsigned cell, unsigned observation) const {
+		return (bits[size_t(cell) * wordsPerCell + observation / 64] >> (observation % 64)) & 1;
+	}
+};
+
+/**
+ * Snapshot of the state of a simulator
+ *
+ * It is opaque to the users of the simulator, who can only restore it with
+ * Simulator::restore().
+ */
+class SimulatorSnapshot {
+public:
+	virtual ~SimulatorSnapshot();
+};
+
 /**
  * Main simulator class
  *
@@ -278,6 +445,49 @@ public:
 	 */
 	static Simulator* createInstance(int argc, char** argv);
 
+	/**
+	 * Create an instance of the simulator.
+	 *
+	 * @param simParams simulation parameters
+	 * @param scenarioParams parameters to generate the scenario
+	 * @return pointer to simulator instance or nullptr if the parameters
+	 * 	are not valid
+	 */
+	static Simulator* createInstance(const SimulationParams& simParams,
+			const ScenarioParams& scenarioParams);
+
+	/**
+	 * Parse simulator command line arguments.
+	 *
+	 * This supports the same arguments as createInstance(argc, argv), but
+	 * only fills the parameters instead of instantiating the simulator.
+	 *
+	 * @param argc number of arguments counting argv[0]
+	 * @param argv null-terminated array of arguments
+	 * @param simParams parameters to be filled in
+	 * @param scenarioParams parameters to be filled in
+	 * @return false if there was a problem parsing the arguments
+	 */
+	static bool parseArguments(int argc, char** argv,
+			SimulationParams& simParams, ScenarioParams& scenarioParams);
+
+	/**
+	 * Generate a scenario and write it to a file
+	 *
+	 * The file can be used later with ScenarioParams::scenarioFile to
+	 * create simulators for the same scenario. It is memory-mapped when it is
+	 * loaded, so that it does not have to be parsed, and processes that load
+	 * it share its memory.
+	 *
+	 * @param path file to write
+	 * @param simParams simulation parameters that define the map
+	 * @param scenarioParams parameters to generate the scenario
+	 * @throws std::invalid_argument if the parameters are not valid
+	 * @throws std::runtime_error if the file cannot be written
+	 */
+	static void writeScenario(const std::string& path, const SimulationParams& simParams,
+			const ScenarioParams& scenarioParams);
+
 	/**
 	 * Print help about the supported arguments for the simulator.
 	 */
@@ -307,6 +517,37 @@ public:
 	 */
 	virtual TeamState getState() = 0;
 
+	/**
+	 * Return state of the team into a struct owned by the caller
+	 *
+	 * @param state where the state of the team is stored
+	 */
+	virtual void getState(TeamState& state) = 0;
+
+	/**
+	 * Gets the cells in front of the team, in the direction of travel
+	 *
+	 * These are the cells that the forward-looking sensors read, including
+	 * those outside of the map. They are computed from the direction of
+	 * travel precomputed for the route, and the memory of forwardCells is
+	 * reused, so calling this once per step does not allocate memory.
+	 *
+	 * @param cells number of cells
+	 * @param forwardCells where the coordinates of the cells are stored
+	 */
+	virtual void getForwardCells(unsigned cells, Route& forwardCells) const = 0;
+
+	/**
+	 * Gets how many of the cells in front of the team are inside the map
+	 *
+	 * The forward-looking sensors read the cells outside of the map as
+	 * empty, so reading only these cells senses the same objects.
+	 *
+	 * @param cells number of cells
+	 * @return number of leading cells that are inside the map, at most cells
+	 */
+	virtual unsigned getForwardCellsInMap(unsigned cells) const = 0;
+
 	/**
 	 * Read the forward-looking threat sensor
 	 *
@@ -333,6 +574,34 @@ public:
 	 */
 	virtual std::vector<bool> readForwardTargetSensor(unsigned cells) = 0;
 
+	/**
+	 * Read the forward-looking threat sensor into a buffer owned by the caller
+	 *
+	 * This is the same as readForwardThreatSensor(cells), but it does not
+	 * allocate memory.
+	 *
+	 * @param cells number of cells to sense
+	 * @param sensed buffer of at least cells elements where the readings
+	 * 	are stored
+	 * @return number of cells sensed, which is less than cells if the cells
+	 * 	ahead of the team go out of the map
+	 */
+	virtual unsigned readForwardThreatSensor(unsigned cells, bool* sensed) = 0;
+
+	/**
+	 * Read the forward-looking target sensor into a buffer owned by the caller
+	 *
+	 * This is the same as readForwardTargetSensor(cells), but it does not
+	 * allocate memory.
+	 *
+	 * @param cells number of cells to sense
+	 * @param sensed buffer of at least cells elements where the readings
+	 * 	are stored
+	 * @return number of cells sensed, which is less than cells if the cells
+	 * 	ahead of the team go out of the map
+	 */
+	virtual unsigned readForwardTargetSensor(unsigned cells, bool* sensed) = 0;
+
 	/**
 	 * Read several observations with the forward-looking threat sensor
 	 *
@@ -375,6 +644,72 @@ public:
 	 */
 	virtual std::vector<std::vector<bool> > readForwardTargetSensor(unsigned cells, unsigned numOfObservations) = 0;
 
+	/**
+	 * Read several observations with the forward-looking threat sensor
+	 *
+	 * This produces the same observations as the version that returns
+	 * vectors, but it generates them in blocks and stores them in a
+	 * buffer provided by the caller, along with the count of positive
+	 * observations of each cell.
+	 *
+	 * @param cells number of cells to sense
+	 * @param numOfObservations number of observations to take for each cell
+	 * @param readings where the observations are stored
+	 */
+	virtual void readForwardThreatSensor(unsigned cells, unsigned numOfObservations,
+			SensorReadings& readings) = 0;
+
+	/**
+	 * Read several observations with the forward-looking target sensor
+	 *
+	 * This produces the same observations as the version that returns
+	 * vectors, but it generates them in blocks and stores them in a
+	 * buffer provided by the caller, along with the count of positive
+	 * observations of each cell.
+	 *
+	 * @param cells number of cells to sense
+	 * @param numOfObservations number of observations to take for each cell
+	 * @param readings where the observations are stored
+	 */
+	virtual void readForwardTargetSensor(unsigned cells, unsigned numOfObservations,
+			SensorReadings& readings) = 0;
+
+	/**
+	 * Count the positive observations of the forward-looking threat sensor
+	 *
+	 * This is equivalent to counting the positive observations of each cell
+	 * returned by readForwardThreatSensor(cells, numOfObservations), but the
+	 * counts are sampled directly from a binomial distribution, so the cost
+	 * does not depend on the number of observations. The counts are not the
+	 * same that would be obtained from the individual observations.
+	 *
+	 * @param cells number of cells to sense
+	 * @param numOfObservations number of observations to take for each cell
+	 * @return number of positive observations for each cell. The size of
+	 * 	the vector could be less than cells if the cells ahead of the team
+	 * 	go out of the map.
+	 */
+	virtual std::vector<unsigned> readForwardThreatSensorCounts(unsigned cells,
+			unsigned numOfObservations) = 0;
+
+	/**
+	 * Count the positive observations of the forward-looking target sensor
+	 *
+	 * This is equivalent to counting the positive observations of each cell
+	 * returned by readForwardTargetSensor(cells, numOfObservations), but the
+	 * counts are sampled directly from a binomial distribution, so the cost
+	 * does not depend on the number of observations. The counts are not the
+	 * same that would be obtained from the individual observations.
+	 *
+	 * @param cells number of cells to sense
+	 * @param numOfObservations number of observations to take for each cell
+	 * @return number of positive observations for each cell. The size of
+	 * 	the vector could be less than cells if the cells ahead of the team
+	 * 	go out of the map.
+	 */
+	virtual std::vector<unsigned> readForwardTargetSensorCounts(unsigned cells,
+			unsigned numOfObservations) = 0;
+
 
 	/**
 	 * Executes one simulation step
@@ -386,6 +721,19 @@ public:
 	 */
 	virtual bool step(const TacticList& tactics, double decisionTimeMsec = 0.0) = 0;
 
+	/**
+	 * Executes one simulation step
+	 *
+	 * This is the same as step(const TacticList&, double), but it does not
+	 * allocate memory.
+	 *
+	 * @param tactics tactics to execute (can be empty)
+	 * @param decisionTimeMsec the amount of time in milliseconds that the
+	 * 	adaptation manager took to make the adaptation decision
+	 * @return true if a target was detected with the downward-looking sensor
+	 */
+	virtual bool step(TacticSet tactics, double decisionTimeMsec = 0.0) = 0;
+
 	/**
 	 * Get results of the simulation
 	 *
@@ -396,10 +744,69 @@ public:
 	/**
 	 * Get text rendering of screen output
 	 *
+	 * The screen is rendered from the trajectory of the team, so if
+	 * SimulationParams::recordTrajectory is false, it only shows the
+	 * threats and targets along the route.
+	 *
 	 * @return string with multi-line screen output
 	 */
 	virtual std::string getScreenOutput() = 0;
 
+	/**
+	 * Get the latencies of the phases of the simulation
+	 *
+	 * They are only measured if SimulationParams::collectMetrics is true.
+	 * Forks of the simulator measure their own latencies.
+	 *
+	 * @return snapshot of the latency histograms
+	 */
+	virtual SimulatorMetrics getMetrics() const = 0;
+
+	/**
+	 * Take a snapshot of the state of the simulation
+	 *
+	 * The snapshot includes the state of the team, the state of the random
+	 * number generators, the statistics of the mission, and the screen, so
+	 * that the simulation can be rewound to this point with restore().
+	 * The snapshot shares the recorded trajectory and decision times with
+	 * the simulator instead of copying them, so its cost does not grow with
+	 * the number of steps taken.
+	 *
+	 * @return snapshot of the simulation state
+	 */
+	virtual std::shared_ptr<const SimulatorSnapshot> snapshot() const = 0;
+
+	/**
+	 * Restore the state of the simulation to a snapshot
+	 *
+	 * The snapshot can be restored more than once, and it can also be
+	 * restored in forks of the simulator that took it. Forks do not record
+	 * the trajectory, so restoring a snapshot taken by a fork clears the
+	 * trajectory shown by getScreenOutput().
+	 *
+	 * @param snapshot snapshot taken with snapshot()
+	 * @throws std::invalid_argument if the snapshot was taken by a
+	 * 	simulator of a different mission
+	 */
+	virtual void restore(const SimulatorSnapshot& snapshot) = 0;
+
+	/**
+	 * Create an independent copy of the simulator
+	 *
+	 * The copy continues the simulation from the current state, and running
+	 * it does not affect this simulator. The environment and route of the
+	 * mission, which are never modified, are shared by the copy instead of
+	 * being copied, so forking is cheap enough to do many rollouts for a
+	 * single decision.
+	 *
+	 * The copy does not report events to the event sink, does not record the
+	 * trajectory of the team, and its results and metrics only include the
+	 * decision times and latencies of its own steps.
+	 *
+	 * @return pointer to new simulator instance, owned by the caller
+	 */
+	virtual Simulator* fork() const = 0;
+
 	virtual ~Simulator();
 };
 
@@ -0,0 +1,208 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Adaptation tactics
+ *
+ * The value of each tactic is the index of its bit in a TacticSet
+ */
+enum class Tactic : uint8_t {
+	INC_ALTITUDE,
+	DEC_ALTITUDE,
+	INC_ALTITUDE2,
+	DEC_ALTITUDE2,
+	GO_TIGHT,
+	GO_LOOSE,
+	ECM_ON,
+	ECM_OFF
+};
+
+/**
+ * @return the label of a tactic, such as "IncAlt", which is how tactics are
+ * 	named in the TCP interface and in Simulator::TacticList
+ */
+constexpr const char* getTacticLabel(Tactic tactic) {
+	switch (tactic) {
+	case Tactic::INC_ALTITUDE:
+		return "IncAlt";
+	case Tactic::DEC_ALTITUDE:
+		return "DecAlt";
+	case Tactic::INC_ALTITUDE2:
+		return "IncAlt2";
+	case Tactic::DEC_ALTITUDE2:
+		return "DecAlt2";
+	case Tactic::GO_TIGHT:
+		return "GoTight";
+	case Tactic::GO_LOOSE:
+		return "GoLoose";
+	case Tactic::ECM_ON:
+		return "EcmOn";
+	case Tactic::ECM_OFF:
+		return "EcmOff";
+	}
+	return "";
+}
+
+/**
+ * Set of tactics stored as a bitmask
+ *
+ * Unlike Simulator::TacticList, it never allocates memory, so it can be used
+ * to step the simulation without heap allocations.
+ */
+class TacticSet {
+public:
+	static constexpr unsigned NUM_TACTICS = 8;
+
+	constexpr TacticSet() : mask(0) {}
+
+	constexpr TacticSet(std::initializer_list<Tactic> tactics) : mask(0) {
+		for (auto tactic : tactics) {
+			insert(tactic);
+		}
+	}
+
+	/**
+	 * @param mask bitmask with bit i set if Tactic(i) is in the set
+	 */
+	static constexpr TacticSet fromMask(uint8_t mask) {
+		TacticSet tactics;
+		tactics.mask = mask;
+		return tactics;
+	}
+
+	constexpr uint8_t getMask() const {
+		return mask;
+	}
+
+	constexpr bool empty() const {
+		return mask == 0;
+	}
+
+	constexpr bool contains(Tactic tactic) const {
+		return (mask >> unsigned(tactic)) & 1;
+	}
+
+	constexpr TacticSet& insert(Tactic tactic) {
+		mask |= uint8_t(1u << unsigned(tactic));
+		return *this;
+	}
+
+	constexpr TacticSet& erase(Tactic tactic) {
+		mask &= uint8_t(~(1u << unsigned(tactic)));
+		return *this;
+	}
+
+	/**
+	 * Create a set from tactic labels
+	 *
+	 * When it is used to initialize a constexpr variable, an unknown label
+	 * is a compile-time error. For example,
+	 * constexpr auto tactics = TacticSet::fromLabels({"IncAlt", "GoTight"});
+	 *
+	 * @throws std::invalid_argument if a label is unknown
+	 */
+	static constexpr TacticSet fromLabels(std::initializer_list<const char*> labels);
+
+	constexpr bool operator==(const TacticSet& other) const {
+		return mask == other.mask;
+	}
+
+	constexpr bool operator!=(const TacticSet& other) const {
+		return mask != other.mask;
+	}
+
+private:
+	uint8_t mask;
+};
+
+/**
+ * Find the tactic with a label
+ *
+ * @param label label of the tactic, which does not need to be terminated
+ * @param length length of the label
+ * @param tactic set to the tactic if it is found
+ * @return false if there is no tactic with that label
+ */
+constexpr bool findTactic(const char* label, size_t length, Tactic& tactic) {
+	for (unsigned t = 0; t < TacticSet::NUM_TACTICS; t++) {
+		const char* tacticLabel = getTacticLabel(Tactic(t));
+		size_t c = 0;
+		while (c < length && tacticLabel[c] != '\0' && tacticLabel[c] == label[c]) {
+			c++;
+		}
+		if (c == length && tacticLabel[c] == '\0') {
+			tactic = Tactic(t);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @return the tactic with a label
+ * @throws std::invalid_argument if there is no tactic with that label
+ */
+constexpr Tactic parseTactic(const char* label) {
+	size_t length = 0;
+	while (label[length] != '\0') {
+		length++;
+	}
+
+	Tactic tactic = Tactic::INC_ALTITUDE;
+	if (!findTactic(label, length, tactic)) {
+		throw std::invalid_argument(std::string("unknown tactic ") + label);
+	}
+	return tactic;
+}
+
+constexpr TacticSet TacticSet::fromLabels(std::initializer_list<const char*> labels) {
+	TacticSet tactics;
+	for (auto label : labels) {
+		tactics.insert(parseTactic(label));
+	}
+	return tactics;
+}
+
+/**
+ * @return the label of a tactic as one of the constants of Simulator,
+ * 	such as Simulator::INC_ALTITUDE
+ */
+const std::string& getTacticName(Tactic tactic);
+
+} /* namespace sim */
+} /* namespace dart */
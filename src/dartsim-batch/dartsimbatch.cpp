@@ -0,0 +1,240 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+#include <dartsim/Simulator.h>
+#include <dartsim/BatchRunner.h>
+#include <iostream>
+#include <fstream>
+#include <getopt.h>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+using namespace dart::sim;
+
+using myclock = chrono::high_resolution_clock;
+
+enum ARGS {
+	RUNS,
+	THREADS,
+	OUTPUT,
+	LOOKAHEAD_horizon
+};
+
+static struct option long_options[] = {
+    {"runs",  required_argument, 0,  RUNS },
+    {"threads",  required_argument, 0,  THREADS },
+    {"output",  required_argument, 0,  OUTPUT },
+    {"lookahead-horizon",  required_argument, 0,  LOOKAHEAD_horizon },
+    {0, 0, 0, 0 }
+};
+
+static void usage() {
+	cout << "options: " << endl;
+	cout << "\t[simulator options] [-- [batch options]]" << endl;
+	cout << "the simulator option --seed sets the seed of the first run" << endl;
+	Simulator::usage();
+	cout << "valid batch options are:" << endl;
+	int opt = 0;
+	while (long_options[opt].name != 0) {
+		cout << "\t--" << long_options[opt].name;
+		if (long_options[opt].has_arg == required_argument) {
+			cout << "=value";
+		}
+		cout << endl;
+		opt++;
+	}
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * Simple adaptation manager, the same used in the simple-cpp example
+ */
+static void runSimpleAdaptationManager(Simulator& sim, unsigned horizon) {
+	auto simParams = sim.getParameters();
+	const unsigned minAltitude = 1;
+	const unsigned maxAltitude = simParams.altitudeLevels;
+
+	while (!sim.finished()) {
+		auto startTime = myclock::now();
+		auto state = sim.getState();
+		auto threats = sim.readForwardThreatSensor(horizon);
+		auto targets = sim.readForwardTargetSensor(horizon);
+
+		TacticSet tactics;
+		bool threatAhead = any_of(threats.begin(), threats.end(), [](bool p){return p;});
+		if (threatAhead && state.config.altitudeLevel < maxAltitude) {
+			tactics.insert(Tactic::INC_ALTITUDE);
+		} else {
+			bool targetAhead = any_of(targets.begin(), targets.end(), [](bool p){return p;});
+			if (targetAhead && state.config.altitudeLevel > minAltitude) {
+				tactics.insert(Tactic::DEC_ALTITUDE);
+			}
+		}
+
+		if (!threats.empty() && threats[0]) { // is there an immediate threat?
+			if (state.config.formation != TeamConfiguration::Formation::TIGHT) {
+				tactics.insert(Tactic::GO_TIGHT);
+			}
+		} else if (state.config.formation != TeamConfiguration::Formation::LOOSE) {
+			tactics.insert(Tactic::GO_LOOSE);
+		}
+
+		auto delta = myclock::now() - startTime;
+		double deltaMsec = chrono::duration_cast<chrono::duration<double, std::milli>>(delta).count();
+
+		sim.step(tactics, deltaMsec);
+	}
+}
+
+int main(int argc, char** argv) {
+	unsigned runs = 100;
+	unsigned threads = 0;
+	unsigned horizon = 5;
+	string outputPath;
+
+	/*
+	 * Split all command-line options first
+	 * All the options before a -- arg are for the sim, the rest are for
+	 * the batch
+	 */
+	int simArgc = 0;
+
+	while (simArgc < argc) {
+		if (strcmp(argv[simArgc++], "--") == 0) {
+			simArgc--;
+			break;
+		}
+	}
+
+	int batchArgc = argc - simArgc;
+	if (batchArgc) {
+		argv[simArgc] = argv[0];
+		char **batchArgv = argv + simArgc;
+
+		while (1) {
+			int option_index = 0;
+
+			auto c = getopt_long(batchArgc, batchArgv, "", long_options, &option_index);
+
+			if (c == -1) {
+				break;
+			}
+
+			switch (c) {
+			case RUNS:
+				runs = atoi(optarg);
+				break;
+			case THREADS:
+				threads = atoi(optarg);
+				break;
+			case OUTPUT:
+				outputPath = optarg;
+				break;
+			case LOOKAHEAD_horizon:
+				horizon = atoi(optarg);
+				if (horizon < 1) {
+					cout << "error: horizon must be >= 1" << endl;
+					usage();
+				}
+				break;
+			default:
+				usage();
+			}
+		}
+
+		if (optind < batchArgc) {
+			usage();
+		}
+	}
+
+	optind = 1; // reset getopt scanning
+	argv[simArgc] = nullptr;
+
+	SimulationParams simParams;
+	ScenarioParams scenarioParams;
+	if (!Simulator::parseArguments(simArgc, argv, simParams, scenarioParams)) {
+		usage();
+	}
+	int firstSeed = (scenarioParams.seeded) ? scenarioParams.seed : 1;
+
+	// the screen output is not used, so there is no need to record trajectories
+	simParams.recordTrajectory = false;
+
+	BatchRunner batch(simParams, scenarioParams,
+			[horizon](Simulator& sim) { runSimpleAdaptationManager(sim, horizon); });
+
+	auto startTime = myclock::now();
+	BatchResults results = batch.run(firstSeed, runs, threads);
+	auto delta = myclock::now() - startTime;
+	double deltaSec = chrono::duration_cast<chrono::duration<double>>(delta).count();
+
+	ofstream outputFile;
+	if (!outputPath.empty()) {
+		outputFile.open(outputPath);
+		if (!outputFile) {
+			cout << "error: could not open " << outputPath << endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+	ostream& out = (outputFile.is_open()) ? outputFile : cout;
+
+	out << "seed,targetsDetected,destroyed,whereDestroyedX,missionSuccess,decisionTimeAvg,decisionTimeVar,"
+			"decisionTimeP50,decisionTimeP90,decisionTimeP99,decisionTimeMax\n";
+	for (unsigned r = 0; r < results.missions.size(); r++) {
+		const auto& mission = results.missions[r];
+		out << results.seeds[r]
+			<< ',' << mission.targetsDetected
+			<< ',' << mission.destroyed
+			<< ',' << mission.whereDestroyed.x
+			<< ',' << mission.missionSuccess
+			<< ',' << mission.decisionTimeAvg
+			<< ',' << mission.decisionTimeVar
+			<< ',' << mission.decisionTimeP50
+			<< ',' << mission.decisionTimeP90
+			<< ',' << mission.decisionTimeP99
+			<< ',' << mission.decisionTimeMax
+			<< '\n';
+	}
+	out.flush();
+
+	const std::string RESULTS_PREFIX = "out:";
+	cout << RESULTS_PREFIX << "runs=" << runs << endl;
+	cout << RESULTS_PREFIX << "destroyed=" << results.destroyed << endl;
+	cout << RESULTS_PREFIX << "missionSuccesses=" << results.missionSuccesses << endl;
+	cout << RESULTS_PREFIX << "targetsDetectedAvg=" << results.targetsDetectedAvg << endl;
+	cout << RESULTS_PREFIX << "decisionTimeAvg=" << results.decisionTimeAvg << endl;
+	cout << RESULTS_PREFIX << "decisionTimeP50=" << results.decisionTimeP50 << endl;
+	cout << RESULTS_PREFIX << "decisionTimeP90=" << results.decisionTimeP90 << endl;
+	cout << RESULTS_PREFIX << "decisionTimeP99=" << results.decisionTimeP99 << endl;
+	cout << RESULTS_PREFIX << "decisionTimeMax=" << results.decisionTimeMax << endl;
+	cout << RESULTS_PREFIX << "elapsedSec=" << deltaSec << endl;
+
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#include <dartsim/Simulator.h>
+#include <iostream>
+#include <getopt.h>
+#include <cstdlib>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace dart::sim;
+
+using myclock = chrono::high_resolution_clock;
+
+enum ARGS {
+	RUNS,
+	OUTPUT
+};
+
+static struct option long_options[] = {
+    {"runs",  required_argument, 0,  RUNS },
+    {"output",  required_argument, 0,  OUTPUT },
+    {0, 0, 0, 0 }
+};
+
+static void usage() {
+	cout << "options: " << endl;
+	cout << "\t[simulator options] -- --output=file [--runs=value]" << endl;
+	cout << "the simulator option --seed sets the seed of the first scenario" << endl;
+	cout << "with --runs greater than 1, the scenario of each seed is written to file-seed" << endl;
+	Simulator::usage();
+	cout << "valid scenario options are:" << endl;
+	int opt = 0;
+	while (long_options[opt].name != 0) {
+		cout << "\t--" << long_options[opt].name;
+		if (long_options[opt].has_arg == required_argument) {
+			cout << "=value";
+		}
+		cout << endl;
+		opt++;
+	}
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
+	unsigned runs = 1;
+	string outputPath;
+
+	/*
+	 * Split all command-line options first
+	 * All the options before a -- arg are for the sim, the rest are for
+	 * the generator
+	 */
+	int simArgc = 0;
+
+	while (simArgc < argc) {
+		if (strcmp(argv[simArgc++], "--") == 0) {
+			simArgc--;
+			break;
+		}
+	}
+
+	int scenarioArgc = argc - simArgc;
+	if (scenarioArgc) {
+		argv[simArgc] = argv[0];
+		char **scenarioArgv = argv + simArgc;
+
+		while (1) {
+			int option_index = 0;
+
+			auto c = getopt_long(scenarioArgc, scenarioArgv, "", long_options, &option_index);
+
+			if (c == -1) {
+				break;
+			}
+
+			switch (c) {
+			case RUNS:
+				runs = atoi(optarg);
+				break;
+			case OUTPUT:
+				outputPath = optarg;
+				break;
+			default:
+				usage();
+			}
+		}
+
+		if (optind < scenarioArgc) {
+			usage();
+		}
+	}
+
+	if (outputPath.empty() || runs < 1) {
+		usage();
+	}
+
+	optind = 1; // reset getopt scanning
+	argv[simArgc] = nullptr;
+
+	SimulationParams simParams;
+	ScenarioParams scenarioParams;
+	if (!Simulator::parseArguments(simArgc, argv, simParams, scenarioParams)
+			|| !scenarioParams.scenarioFile.empty()) {
+		usage();
+	}
+	int firstSeed = (scenarioParams.seeded) ? scenarioParams.seed : 1;
+	scenarioParams.seeded = true;
+
+	auto startTime = myclock::now();
+	for (unsigned r = 0; r < runs; r++) {
+		scenarioParams.seed = firstSeed + r;
+		string path = (runs == 1) ? outputPath : outputPath + '-' + to_string(scenarioParams.seed);
+		try {
+			Simulator::writeScenario(path, simParams, scenarioParams);
+		} catch (std::exception& e) {
+			cout << "error: " << e.what() << endl;
+			return EXIT_FAILURE;
+		}
+	}
+	auto delta = myclock::now() - startTime;
+	double deltaSec = chrono::duration_cast<chrono::duration<double>>(delta).count();
+
+	const std::string RESULTS_PREFIX = "out:";
+	cout << RESULTS_PREFIX << "scenarios=" << runs << endl;
+	cout << RESULTS_PREFIX << "elapsedSec=" << deltaSec << endl;
+
+	return 0;
+}
@@ -28,45 +28,34 @@
 
 #include "AdaptInterface.h"
 #include "assert.h"
-#include <boost/tokenizer.hpp>
-#include <set>
-#include <map>
+#include <cstring>
+#include <stdexcept>
 
 #define DEBUG_ADAPT_INTERFACE 0
 
-using namespace json11;
 using namespace boost::asio;
 using namespace boost::asio::ip;
 
 namespace dart {
 namespace sim {
 
-static const std::string UNKNOWN_COMMAND = "error: unknown command\n";
-static const std::string INVALID_ARGUMENTS = "error: invalid arguments count\n";
-static const std::string COMMAND_SUCCESS = "OK\n";
-
 AdaptInterface::AdaptInterface(dart::sim::Simulator* simulatorP, unsigned port)
 		: mSimulatorP(simulatorP),
 		  mPort(port),
 		  mIOServiceP(nullptr),
 		  mEndPointP(nullptr),
 		  mAcceptorP(nullptr),
-		  mSocketP(nullptr) {
+		  mSocketP(nullptr),
+		  mCommandProcessor(simulatorP),
+		  mBinaryCommandProcessor(mCommandProcessor),
+		  mBinaryProtocol(false) {
 	assert(mSimulatorP != nullptr);
+	mCommandProcessor.registerCommand("binaryProtocol",
+			std::bind(&AdaptInterface::cmdBinaryProtocol, this, std::placeholders::_1),
+			false);
 	mIOServiceP = new io_service();
 	mEndPointP = new tcp::endpoint(tcp::v4(), mPort);
 	mAcceptorP = new tcp::acceptor(*mIOServiceP, *mEndPointP);
-
-	mCommandHandlers["finished"] = std::bind(&AdaptInterface::cmdFinished, this, std::placeholders::_1);
-	mCommandHandlers["getState"] = std::bind(&AdaptInterface::cmdGetState, this, std::placeholders::_1);
-	mCommandHandlers["readForwardThreatSensor"] = std::bind(&AdaptInterface::cmdReadForwardThreatSensor, this, std::placeholders::_1);
-	mCommandHandlers["readForwardTargetSensor"] = std::bind(&AdaptInterface::cmdReadForwardTargetSensor, this, std::placeholders::_1);
-	mCommandHandlers["readForwardThreatSensorForObservations"] = std::bind(&AdaptInterface::cmdReadForwardThreatSensorForObservations, this, std::placeholders::_1);
-	mCommandHandlers["readForwardTargetSensorForObservations"] = std::bind(&AdaptInterface::cmdReadForwardTargetSensorForObservations, this, std::placeholders::_1);
-	mCommandHandlers["step"] = std::bind(&AdaptInterface::cmdStep, this, std::placeholders::_1);
-	mCommandHandlers["getResults"] = std::bind(&AdaptInterface::cmdGetResults, this, std::placeholders::_1);
-	mCommandHandlers["getScreenOutput"] = std::bind(&AdaptInterface::cmdGetScreenOutput, this, std::placeholders::_1);
-	mCommandHandlers["getParameters"] = std::bind(&AdaptInterface::cmdGetParameters, this, std::placeholders::_1);
 }
 
 AdaptInterface::~AdaptInterface() {
@@ -90,6 +79,10 @@ AdaptInterface::~AdaptInterface() {
 	}
 }
 
+unsigned AdaptInterface::getPort() const {
+	return mAcceptorP->local_endpoint().port();
+}
+
 void AdaptInterface::serviceClient() {
 	mSocketP = new tcp::socket(*mIOServiceP);
 	boost::system::error_code errorCode;
@@ -103,25 +96,51 @@ void AdaptInterface::serviceClient() {
 	std::cout << "Simulation client connected" << std::endl;
 
 	while (true) {
-		auto cmd = readCmd();
-		if (!cmd) {
+		if (mBinaryProtocol) {
+			bool received;
+			{
+				LatencyTimer timer(&mCommandProcessor.getMetrics().receive);
+				received = readFrame();
+			}
+			if (!received) {
+
+				// connection closed
+				break;
+			}
+			handleClientFrame(mFrame.data(), mFrame.size());
+		} else {
+			std::shared_ptr<std::string> cmd;
+			{
+				LatencyTimer timer(&mCommandProcessor.getMetrics().receive);
+				cmd = readCmd();
+			}
+			if (!cmd) {
+
+				// connection closed
+				break;
+			}
+			handleClientCmd(*cmd);
+		}
 
-			// connection closed
-			break;
+		// the replies to commands pipelined by the client are sent in one write
+		if (!hasBufferedCommand()) {
+			flushReplies();
 		}
-		handleClientCmd(*cmd);
 	}
 
 	mSocketP->close();
 }
 
-std::shared_ptr<std::string> AdaptInterface::readCmd() const {
+std::shared_ptr<std::string> AdaptInterface::readCmd() {
 	std::shared_ptr<std::string> cmd; // default to a nullptr for connection closed
-	boost::asio::streambuf buf;
 	boost::system::error_code error;
-	boost::asio::read_until(*mSocketP, buf, "\n", error );
+	boost::asio::read_until(*mSocketP, mReadBuffer, "\n", error );
 	if (!error) {
-		cmd.reset(new std::string(boost::asio::buffer_cast<const char*>(buf.data())));
+
+		// the buffer may hold more than one line if the client did not wait for the reply
+		cmd.reset(new std::string);
+		std::istream input(&mReadBuffer);
+		std::getline(input, *cmd);
 
 		// remove trailing returns
 		cmd->erase(cmd->find_last_not_of("\r\n") + 1);
@@ -137,265 +156,90 @@ std::shared_ptr<std::string> AdaptInterface::readCmd() const {
 	return cmd;
 }
 
-void AdaptInterface::sendBytes(const std::string& bytes) const {
-#if DEBUG_ADAPT_INTERFACE
-	std::cout << "Command Reply is [ " << bytes << " ]" << std::endl;
-#endif
-    boost::system::error_code errorCode;
-	boost::asio::write(*mSocketP, boost::asio::buffer(bytes + "\n"), errorCode);
-
-	if (errorCode) {
-		throw boost::system::system_error(errorCode);
+bool AdaptInterface::readFrame() {
+	boost::system::error_code error;
+	if (mReadBuffer.size() < BinaryCommandProcessor::FRAME_HEADER_SIZE) {
+		boost::asio::read(*mSocketP, mReadBuffer,
+				transfer_exactly(BinaryCommandProcessor::FRAME_HEADER_SIZE - mReadBuffer.size()),
+				error);
 	}
-}
-
-void AdaptInterface::handleClientCmd(const std::string& cmd) {
-	typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
-	tokenizer tokens(cmd, boost::char_separator<char>(" \n[],"));
-	tokenizer::iterator it = tokens.begin();
 
-	if (it != tokens.end()) {
-		std::string command = *it;
-		std::vector<std::string> args;
-
-		while (++it != tokens.end()) {
-#if DEBUG_ADAPT_INTERFACE
-			std::cout << "argument " << *it << std::endl;
-#endif
-			args.push_back(*it);
+	if (!error) {
+		char header[BinaryCommandProcessor::FRAME_HEADER_SIZE];
+		mReadBuffer.sgetn(header, sizeof(header));
+		uint32_t size = BinaryCommandProcessor::decodeFrameSize(header);
+		if (size > BinaryCommandProcessor::MAX_FRAME_SIZE) {
+			throw std::runtime_error("frame too large");
 		}
 
-		auto handler = mCommandHandlers.find(command);
-		if (handler == mCommandHandlers.end()) {
-			sendBytes(UNKNOWN_COMMAND);
-		} else {
-			std::string reply = mCommandHandlers[command](args);
-			sendBytes(reply);
+		if (mReadBuffer.size() < size) {
+			boost::asio::read(*mSocketP, mReadBuffer,
+					transfer_exactly(size - mReadBuffer.size()), error);
+		}
+		if (!error) {
+			mFrame.resize(size);
+			mReadBuffer.sgetn(mFrame.data(), size);
+			return true;
 		}
 	}
-}
-
-std::string AdaptInterface::cmdFinished(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	if (args.empty()) {
-		bool finished = mSimulatorP->finished();
-		result = Json(finished).dump();
-	} else {
-		sendBytes(INVALID_ARGUMENTS);
-	}
-
-	return result;
-}
-
-std::string AdaptInterface::cmdGetState(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	if (args.empty()) {
-		dart::sim::TeamState state = mSimulatorP->getState();
-		Json jsonState = convertTeamStateToJson(state);
-		result = jsonState.dump();
-	} else {
-		sendBytes(INVALID_ARGUMENTS);
-	}
-
-	return result;
-}
-
-std::string AdaptInterface::cmdReadForwardThreatSensor(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	if (args.size() == 1) {
-		unsigned cell = stoul(args[0]);
-		std::vector<bool> threats = mSimulatorP->readForwardThreatSensor(cell);
-		Json jsonThreats = Json(threats);
-		result = jsonThreats.dump();
-	} else {
-		sendBytes(INVALID_ARGUMENTS);
-	}
-
-	return result;
-}
-
-
-std::string AdaptInterface::cmdReadForwardTargetSensor(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	if (args.size() == 1) {
-		unsigned cell = stoul(args[0]);
-		std::vector<bool> threats = mSimulatorP->readForwardTargetSensor(cell);
-		Json jsonThreats = Json(threats);
-		result = jsonThreats.dump();
-	} else {
-		sendBytes(INVALID_ARGUMENTS);
-	}
-
-	return result;
-}
 
-std::string AdaptInterface::cmdReadForwardTargetSensorForObservations(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	if (args.size() == 2) {
-		unsigned cell = stoul(args[0]);
-		unsigned observationCount = stoul(args[1]);
-		std::vector<std::vector<bool>> targets = mSimulatorP->readForwardTargetSensor(cell, observationCount);
-		Json jsonThreats = Json(targets);
-		result = jsonThreats.dump();
-	} else {
-		sendBytes(INVALID_ARGUMENTS);
+	if (error != boost::asio::error::eof) {
+		throw boost::system::system_error(error); // Some other error.
 	}
 
-	return result;
+	std::cout << "Client closed connection" << std::endl;
+	return false;
 }
 
-std::string AdaptInterface::cmdReadForwardThreatSensorForObservations(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	if (args.size() == 2) {
-		unsigned cell = stoul(args[0]);
-		unsigned observationCount = stoul(args[1]);
-		std::vector<std::vector<bool>> threats = mSimulatorP->readForwardTargetSensor(cell, observationCount);
-		Json jsonThreats = Json(threats);
-		result = jsonThreats.dump();
-	} else {
-		sendBytes(INVALID_ARGUMENTS);
+bool AdaptInterface::hasBufferedCommand() const {
+	const char* data = buffer_cast<const char*>(mReadBuffer.data());
+	if (mBinaryProtocol) {
+		return BinaryCommandProcessor::isFrameComplete(data, mReadBuffer.size());
 	}
-
-	return result;
+	return memchr(data, '\n', mReadBuffer.size()) != nullptr;
 }
 
-std::string AdaptInterface::cmdStep(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	std::set<std::string> tacticSet;
-	unsigned index = 0;
-	std::string decisionTimeMsecStr = args[args.size() - 1];
-	double decisionTimeMsec = atof(decisionTimeMsecStr.c_str());
-
-	while (index < args.size() - 1) {
-		std::string tactic = args[index];
-		if ( tactic[0] == '"' ) {
-		    tactic.erase( 0, 1 ); // erase the first character
-		    tactic.erase( tactic.size() - 1 ); // erase the last character
-		}
+void AdaptInterface::sendBytes(const std::string& bytes) const {
 #if DEBUG_ADAPT_INTERFACE
-		std::cout << "tactic = " << tactic << std::endl;
+	std::cout << "Command Reply is [ " << bytes << " ]" << std::endl;
 #endif
-		tacticSet.insert(tactic);
+    boost::system::error_code errorCode;
+	boost::asio::write(*mSocketP, boost::asio::buffer(bytes), errorCode);
 
-		++index;
+	if (errorCode) {
+		throw boost::system::system_error(errorCode);
 	}
-
-	bool stepResult = mSimulatorP->step(tacticSet, decisionTimeMsec);
-	result = Json(stepResult).dump();
-
-	return result;
 }
 
-std::string AdaptInterface::cmdGetResults(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	if (args.empty()) {
-		dart::sim::SimulationResults simResults = mSimulatorP->getResults();
-		Json jsonSimResults = convertSimulationResultsToJson(simResults);
-		result = jsonSimResults.dump();
-	} else {
-		sendBytes(INVALID_ARGUMENTS);
+void AdaptInterface::flushReplies() {
+	if (!mPendingReplies.empty()) {
+		LatencyTimer timer(&mCommandProcessor.getMetrics().send);
+		sendBytes(mPendingReplies);
+		mPendingReplies.clear();
 	}
-
-	return result;
 }
 
-std::string AdaptInterface::cmdGetScreenOutput(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	if (args.empty()) {
-		std::string output = mSimulatorP->getScreenOutput();
-		Json jsonOutput = Json(output);
-		result = jsonOutput.dump();
-	} else {
-		sendBytes(INVALID_ARGUMENTS);
+void AdaptInterface::handleClientCmd(const std::string& cmd) {
+	std::string reply = mCommandProcessor.processCommand(cmd);
+	if (!reply.empty()) {
+		mPendingReplies += reply;
+		mPendingReplies += '\n';
 	}
-
-	return result;
 }
 
-std::string AdaptInterface::cmdGetParameters(const std::vector<std::string>& args) {
-	std::string result = "";
-
-	if (args.empty()) {
-		dart::sim::SimulationParams simParams = mSimulatorP->getParameters();
-		Json jsonSimParams = convertSimulationParamsToJson(simParams);
-		result = jsonSimParams.dump();
-	} else {
-		sendBytes(INVALID_ARGUMENTS);
-	}
-
-	return result;
+void AdaptInterface::handleClientFrame(const char* frame, size_t size) {
+	mPendingReplies += mBinaryCommandProcessor.processFrame(frame, size);
 }
 
-Json AdaptInterface::convertSimulationResultsToJson(const dart::sim::SimulationResults& simResults) const {
-	double decisionTimeAvg = -1;
-	double decisionTimeVar = -1;
-
-	if (!std::isnan(simResults.decisionTimeAvg)) {
-		decisionTimeAvg = simResults.decisionTimeAvg;
+std::string AdaptInterface::cmdBinaryProtocol(const std::vector<std::string>& args) {
+	if (!args.empty()) {
+		return CommandProcessor::INVALID_ARGUMENTS;
 	}
 
-	if (!std::isnan(simResults.decisionTimeVar)) {
-		decisionTimeVar = simResults.decisionTimeVar;
-	}
-
-	Json jsonState = Json::object {
-		{"destroyed", simResults.destroyed},
-		{"destruction positionX", simResults.whereDestroyed.x},
-		{"destruction positionY", simResults.whereDestroyed.y},
-		{"targetsDetected", int(simResults.targetsDetected)},
-		{"missionSuccess", simResults.missionSuccess},
-		{"decisionTimeAvg", decisionTimeAvg},
-		{"decisionTimeVar", decisionTimeVar}
-	};
-
-	return jsonState;
+	// the switch takes effect after this reply is sent
+	mBinaryProtocol = true;
+	return CommandProcessor::COMMAND_SUCCESS;
 }
 
-Json AdaptInterface::convertTeamStateToJson(const dart::sim::TeamState& state) const {
-	Json jsonState = Json::object {
-		{"positionX", state.position.x},
-		{"positionY", state.position.y},
-		{"directionX", state.directionX},
-		{"directionY", state.directionY},
-		{"altitudeLevel", int(state.config.altitudeLevel)},
-		{"formation", state.config.formation},
-		{"ecm", state.config.ecm},
-		{"ttcIncAlt", int(state.config.ttcIncAlt)},
-		{"ttcDecAlt", int(state.config.ttcDecAlt)},
-		{"ttcIncAlt2", int(state.config.ttcIncAlt2)},
-		{"ttcDecAlt2", int(state.config.ttcDecAlt2)}
-	};
-
-	return jsonState;
-}
-
-Json AdaptInterface::convertSimulationParamsToJson(const dart::sim::SimulationParams& simParams) const {
-	Json jsonState = Json::object {
-			{"mapSize", int(simParams.mapSize)},
-			{"squareMap", bool(simParams.squareMap)},
-			{"altitudeLevels", int(simParams.altitudeLevels)},
-			{"changeAltitudeLatencyPeriods", int(simParams.changeAltitudeLatencyPeriods)},
-			{"optimalityTest", bool(simParams.optimalityTest)},
-			{"threatSensorFPR", double(simParams.longRangeSensor.threatSensorFPR)},
-			{"threatSensorFNR", double(simParams.longRangeSensor.threatSensorFNR)},
-			{"targetSensorFPR", double(simParams.longRangeSensor.targetSensorFPR)},
-			{"targetSensorFNR", double(simParams.longRangeSensor.targetSensorFNR)},
-			{"targetDetectionFormationFactor", double(simParams.downwardLookingSensor.targetDetectionFormationFactor)},
-			{"targetSensorRange", int(simParams.downwardLookingSensor.targetSensorRange)},
-			{"destructionFormationFactor", double(simParams.threat.destructionFormationFactor)},
-			{"threatRange", int(simParams.threat.threatRange)},
-		};
-
-	return jsonState;
-}
 }
 }
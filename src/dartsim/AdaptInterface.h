@@ -28,12 +28,12 @@
 
 #pragma once
 #include <dartsim/Simulator.h>
+#include "BinaryCommandProcessor.h"
+#include "CommandProcessor.h"
 #include <string>
 #include <boost/asio.hpp>
-#include <json11.hpp>
-#include <vector>
 #include <memory>
-#include <string>
+#include <vector>
 
 
 namespace dart {
@@ -47,30 +47,41 @@ private:
 	boost::asio::ip::tcp::tcp::endpoint* mEndPointP;
 	boost::asio::ip::tcp::tcp::acceptor* mAcceptorP;
 	boost::asio::ip::tcp::tcp::socket* mSocketP;
-	std::map<std::string, std::function<std::string(const std::vector<std::string>&)>> mCommandHandlers;
+	boost::asio::streambuf mReadBuffer;
+	CommandProcessor mCommandProcessor;
+	BinaryCommandProcessor mBinaryCommandProcessor;
+	bool mBinaryProtocol; /**< whether the client switched to the binary protocol */
+	std::vector<char> mFrame; /**< payload of the last frame read */
+	std::string mPendingReplies; /**< replies not sent yet */
 
-	std::shared_ptr<std::string> readCmd() const;
+	std::shared_ptr<std::string> readCmd();
+	bool readFrame();
+	bool hasBufferedCommand() const;
 	void sendBytes(const std::string& bytes) const;
-	json11::Json convertTeamStateToJson(const dart::sim::TeamState& state) const;
-	json11::Json convertSimulationResultsToJson(const dart::sim::SimulationResults& simResults) const;
-	json11::Json convertSimulationParamsToJson(const dart::sim::SimulationParams& simResults) const;
+	void flushReplies();
 
-	std::string cmdFinished(const std::vector<std::string>& args);
-	std::string cmdGetState(const std::vector<std::string>& args);
-	std::string cmdReadForwardThreatSensor(const std::vector<std::string>& args);
-	std::string cmdReadForwardTargetSensor(const std::vector<std::string>& args);
-	std::string cmdReadForwardThreatSensorForObservations(const std::vector<std::string>& args);
-	std::string cmdReadForwardTargetSensorForObservations(const std::vector<std::string>& args);
-	std::string cmdStep(const std::vector<std::string>& args);
-	std::string cmdGetResults(const std::vector<std::string>& args);
-	std::string cmdGetScreenOutput(const std::vector<std::string>& args);
-	std::string cmdGetParameters(const std::vector<std::string>& args);
+	std::string cmdBinaryProtocol(const std::vector<std::string>& args);
 
 public:
 	AdaptInterface(dart::sim::Simulator* simulatorP, unsigned port = 5418);
+
+	/**
+	 * @return port on which the interface listens, which is chosen by the
+	 * 	system if the interface was created with port 0
+	 */
+	unsigned getPort() const;
+
 	void connectToClient();
 	void serviceClient();
+
+	/**
+	 * Executes a command, queueing its reply
+	 *
+	 * The queued replies are sent once there are no more commands pipelined
+	 * by the client.
+	 */
 	void handleClientCmd(const std::string& cmd);
+	void handleClientFrame(const char* frame, size_t size);
 	virtual ~AdaptInterface();
 };
 
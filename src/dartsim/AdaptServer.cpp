@@ -0,0 +1,332 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#include "AdaptServer.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#define DEBUG_ADAPT_INTERFACE 0
+
+using namespace boost::asio;
+using namespace boost::asio::ip;
+
+namespace dart {
+namespace sim {
+
+namespace {
+
+/*
+ * The parsing of the simulator arguments uses getopt, which keeps global state
+ */
+std::mutex argumentParsingMutex;
+
+/*
+ * Options a client can give to newSimulation, and whether they take a
+ * value. The options that name files (--event-log, --event-log-file and
+ * --scenario) are left out, since they would let any peer write or map
+ * files with the permissions of the server.
+ */
+const std::map<std::string, bool> NETWORK_OPTIONS = {
+	{ "map-size", true },
+	{ "square-map", false },
+	{ "num-targets", true },
+	{ "num-threats", true },
+	{ "target-density", true },
+	{ "threat-density", true },
+	{ "altitude-levels", true },
+	{ "threat-range", true },
+	{ "threat-sensor-fpr", true },
+	{ "threat-sensor-fnr", true },
+	{ "target-sensor-fpr", true },
+	{ "target-sensor-fnr", true },
+	{ "dl-target-sensor-range", true },
+	{ "auto-range", false },
+	{ "change-alt-latency", true },
+	{ "seed", true },
+	{ "opt-test", false },
+	{ "sparse-env", false },
+	{ "no-trajectory", false },
+	{ "metrics", false }
+};
+
+/**
+ * @return true if all the arguments are options a client can use
+ */
+bool areNetworkOptions(const std::vector<std::string>& args) {
+	for (size_t a = 0; a < args.size(); a++) {
+		const std::string& arg = args[a];
+		if (arg.compare(0, 2, "--") != 0) {
+			return false;
+		}
+
+		// option names must be complete, since getopt would accept abbreviations
+		const size_t equals = arg.find('=');
+		const auto option = NETWORK_OPTIONS.find(arg.substr(2, equals - 2));
+		if (option == NETWORK_OPTIONS.end()) {
+			return false;
+		}
+
+		// getopt takes the next argument as the value if there is no '='
+		if (option->second && equals == std::string::npos) {
+			a++;
+			if (a < args.size() && args[a].compare(0, 2, "--") == 0) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+}
+
+AdaptSession::AdaptSession(io_service& ioService)
+		: mSocket(ioService),
+		  mBinaryCommandProcessor(mCommandProcessor),
+		  mBinaryProtocol(false) {
+	mCommandProcessor.registerCommand("newSimulation",
+			std::bind(&AdaptSession::cmdNewSimulation, this, std::placeholders::_1),
+			false);
+	mCommandProcessor.registerCommand("binaryProtocol",
+			std::bind(&AdaptSession::cmdBinaryProtocol, this, std::placeholders::_1),
+			false);
+}
+
+AdaptSession::~AdaptSession() {
+}
+
+tcp::socket& AdaptSession::getSocket() {
+	return mSocket;
+}
+
+void AdaptSession::start() {
+	mReceiveStart = std::chrono::steady_clock::now();
+	readCmd();
+}
+
+void AdaptSession::readCmd() {
+	if (hasBufferedCommand()) {
+		processBufferedCommands();
+		return;
+	}
+
+	if (!mBinaryProtocol) {
+		async_read_until(mSocket, mReadBuffer, "\n",
+				std::bind(&AdaptSession::handleRead, shared_from_this(), std::placeholders::_1));
+		return;
+	}
+
+	const size_t available = mReadBuffer.size();
+	size_t missing = BinaryCommandProcessor::FRAME_HEADER_SIZE - std::min(available,
+			BinaryCommandProcessor::FRAME_HEADER_SIZE);
+	if (missing == 0) {
+		uint32_t size = BinaryCommandProcessor::decodeFrameSize(
+				buffer_cast<const char*>(mReadBuffer.data()));
+		if (size > BinaryCommandProcessor::MAX_FRAME_SIZE) {
+
+			// drop the connection, since there is no way to skip the frame
+			std::cout << "Client connection error: frame too large" << std::endl;
+			return;
+		}
+		missing = BinaryCommandProcessor::FRAME_HEADER_SIZE + size - available;
+	}
+
+	async_read(mSocket, mReadBuffer, transfer_exactly(missing),
+			std::bind(&AdaptSession::handleRead, shared_from_this(), std::placeholders::_1));
+}
+
+bool AdaptSession::hasBufferedCommand() const {
+	const char* data = buffer_cast<const char*>(mReadBuffer.data());
+	if (mBinaryProtocol) {
+		return BinaryCommandProcessor::isFrameComplete(data, mReadBuffer.size());
+	}
+	return memchr(data, '\n', mReadBuffer.size()) != nullptr;
+}
+
+void AdaptSession::handleRead(const boost::system::error_code& error) {
+	if (error) {
+
+		// connection closed or failed, the session ends when no handler refers to it
+		if (error != boost::asio::error::eof) {
+			std::cout << "Client connection error: " << error.message() << std::endl;
+		}
+		return;
+	}
+
+	readCmd();
+}
+
+void AdaptSession::processBufferedCommands() {
+	mCommandProcessor.getMetrics().receive.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - mReceiveStart).count());
+
+	// the replies to commands pipelined by the client are sent in one write
+	mReply.clear();
+	while (hasBufferedCommand()) {
+		if (mBinaryProtocol) {
+
+			// the frame is processed in place
+			const char* data = buffer_cast<const char*>(mReadBuffer.data());
+			uint32_t size = BinaryCommandProcessor::decodeFrameSize(data);
+			mReply += mBinaryCommandProcessor.processFrame(
+					data + BinaryCommandProcessor::FRAME_HEADER_SIZE, size);
+			mReadBuffer.consume(BinaryCommandProcessor::FRAME_HEADER_SIZE + size);
+		} else {
+			std::string cmd;
+			std::istream input(&mReadBuffer);
+			std::getline(input, cmd);
+
+			// remove trailing returns
+			cmd.erase(cmd.find_last_not_of("\r\n") + 1);
+#if DEBUG_ADAPT_INTERFACE
+			std::cout << "Command = [" << cmd << "] length=" << cmd.length() << std::endl;
+#endif
+
+			std::string reply = mCommandProcessor.processCommand(cmd);
+			if (!reply.empty()) {
+				mReply += reply;
+				mReply += '\n';
+			}
+		}
+	}
+
+	if (mReply.empty()) {
+		mReceiveStart = std::chrono::steady_clock::now();
+		readCmd();
+	} else {
+		mSendStart = std::chrono::steady_clock::now();
+		async_write(mSocket, buffer(mReply),
+				std::bind(&AdaptSession::handleWrite, shared_from_this(), std::placeholders::_1));
+	}
+}
+
+void AdaptSession::handleWrite(const boost::system::error_code& error) {
+	if (!error) {
+		auto now = std::chrono::steady_clock::now();
+		mCommandProcessor.getMetrics().send.record(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(now - mSendStart).count());
+		mReceiveStart = now;
+		readCmd();
+	}
+}
+
+std::string AdaptSession::cmdNewSimulation(const std::vector<std::string>& args) {
+	if (!areNetworkOptions(args)) {
+		return "error: invalid simulator options";
+	}
+
+	// build argument list for the simulator, as if it came from the command line
+	std::vector<std::string> arguments(args);
+	arguments.insert(arguments.begin(), "dartsim");
+	std::vector<char*> argv;
+	for (auto& arg : arguments) {
+		argv.push_back(&arg[0]);
+	}
+	argv.push_back(nullptr);
+
+	SimulationParams simParams;
+	ScenarioParams scenarioParams;
+	bool validArguments;
+	{
+		std::lock_guard<std::mutex> lock(argumentParsingMutex);
+		validArguments = Simulator::parseArguments(argv.size() - 1, argv.data(),
+				simParams, scenarioParams);
+	}
+	if (!validArguments) {
+		return "error: invalid simulator options";
+	}
+
+	Simulator* simulatorP = Simulator::createInstance(simParams, scenarioParams);
+	if (simulatorP == nullptr) {
+		return "error: invalid simulator options";
+	}
+
+	mCommandProcessor.setSimulator(simulatorP);
+	mSimulatorP.reset(simulatorP);
+
+	return CommandProcessor::COMMAND_SUCCESS;
+}
+
+std::string AdaptSession::cmdBinaryProtocol(const std::vector<std::string>& args) {
+	if (!args.empty()) {
+		return CommandProcessor::INVALID_ARGUMENTS;
+	}
+
+	// the switch takes effect after this reply is sent
+	mBinaryProtocol = true;
+	return CommandProcessor::COMMAND_SUCCESS;
+}
+
+
+AdaptServer::AdaptServer(unsigned port)
+		: mAcceptor(mIOService, tcp::endpoint(tcp::v4(), port)) {
+}
+
+AdaptServer::~AdaptServer() {
+}
+
+void AdaptServer::accept() {
+	auto session = std::make_shared<AdaptSession>(mIOService);
+	mAcceptor.async_accept(session->getSocket(),
+			[this, session](const boost::system::error_code& error) {
+				if (!error) {
+					session->start();
+				}
+				if (mAcceptor.is_open()) {
+					accept();
+				}
+			});
+}
+
+void AdaptServer::run(unsigned numOfThreads) {
+	if (numOfThreads == 0) {
+		numOfThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	accept();
+
+	std::vector<std::thread> threads;
+	for (unsigned t = 1; t < numOfThreads; t++) {
+		threads.emplace_back([this]() { mIOService.run(); });
+	}
+	mIOService.run();
+
+	for (auto& t : threads) {
+		t.join();
+	}
+}
+
+void AdaptServer::stop() {
+	mIOService.stop();
+}
+
+}
+}
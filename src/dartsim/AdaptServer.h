@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+#include <dartsim/Simulator.h>
+#include "BinaryCommandProcessor.h"
+#include "CommandProcessor.h"
+#include <boost/asio.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Connection of a client to the AdaptServer
+ *
+ * Each session has its own simulator, which the client creates with the
+ * newSimulation command. The rest of the commands, including the switch to
+ * the binary protocol, are the same supported by AdaptInterface.
+ */
+class AdaptSession : public std::enable_shared_from_this<AdaptSession> {
+public:
+	AdaptSession(boost::asio::io_service& ioService);
+
+	boost::asio::ip::tcp::socket& getSocket();
+
+	/**
+	 * Starts servicing the client asynchronously
+	 */
+	void start();
+
+	virtual ~AdaptSession();
+
+private:
+	boost::asio::ip::tcp::socket mSocket;
+	boost::asio::streambuf mReadBuffer;
+	std::string mReply; /**< replies being sent */
+	std::unique_ptr<dart::sim::Simulator> mSimulatorP;
+	CommandProcessor mCommandProcessor;
+	BinaryCommandProcessor mBinaryCommandProcessor;
+	bool mBinaryProtocol; /**< whether the client switched to the binary protocol */
+	std::chrono::steady_clock::time_point mReceiveStart; /**< when the session started waiting for commands */
+	std::chrono::steady_clock::time_point mSendStart; /**< when the write of the replies started */
+
+	void readCmd();
+	bool hasBufferedCommand() const;
+	void processBufferedCommands();
+	void handleRead(const boost::system::error_code& error);
+	void handleWrite(const boost::system::error_code& error);
+
+	std::string cmdNewSimulation(const std::vector<std::string>& args);
+	std::string cmdBinaryProtocol(const std::vector<std::string>& args);
+};
+
+/**
+ * TCP server for adaptation managers
+ *
+ * Unlike AdaptInterface, which services a single client, the server accepts
+ * any number of concurrent connections, each with its own simulation. The
+ * connections are serviced asynchronously by a pool of threads.
+ */
+class AdaptServer {
+public:
+	AdaptServer(unsigned port = 5418);
+
+	/**
+	 * Services clients until the server is stopped
+	 *
+	 * @param numOfThreads number of threads servicing the clients, 0 for
+	 * 	one per core
+	 */
+	void run(unsigned numOfThreads = 0);
+
+	/**
+	 * Stops the server
+	 */
+	void stop();
+
+	virtual ~AdaptServer();
+
+private:
+	boost::asio::io_service mIOService;
+	boost::asio::ip::tcp::acceptor mAcceptor;
+
+	void accept();
+};
+
+}
+}
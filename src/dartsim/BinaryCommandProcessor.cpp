@@ -0,0 +1,402 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#include "BinaryCommandProcessor.h"
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace dart {
+namespace sim {
+
+namespace {
+
+uint32_t getUint32(const char* data) {
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+	return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8)
+			| (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+}
+
+uint64_t getUint64(const char* data) {
+	return uint64_t(getUint32(data)) | (uint64_t(getUint32(data + 4)) << 32);
+}
+
+double getDouble(const char* data) {
+	uint64_t bits = getUint64(data);
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void putUint8(std::string& out, uint8_t value) {
+	out.push_back(char(value));
+}
+
+void putUint16(std::string& out, uint16_t value) {
+	out.push_back(char(value & 0xff));
+	out.push_back(char(value >> 8));
+}
+
+void putUint32(std::string& out, uint32_t value) {
+	putUint16(out, value & 0xffff);
+	putUint16(out, value >> 16);
+}
+
+void putUint64(std::string& out, uint64_t value) {
+	putUint32(out, value & 0xffffffff);
+	putUint32(out, value >> 32);
+}
+
+void putDouble(std::string& out, double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	putUint64(out, bits);
+}
+
+void putBits(std::string& out, const std::vector<bool>& bits) {
+	size_t start = out.size();
+	out.append((bits.size() + 7) / 8, '\0');
+	for (size_t i = 0; i < bits.size(); i++) {
+		if (bits[i]) {
+			out[start + i / 8] |= char(1 << (i % 8));
+		}
+	}
+}
+
+void putReadings(std::string& out, const SensorReadings& readings) {
+	size_t start = out.size();
+	out.append((size_t(readings.cells) * readings.observations + 7) / 8, '\0');
+	size_t bit = 0;
+	for (unsigned c = 0; c < readings.cells; c++) {
+		for (unsigned o = 0; o < readings.observations; o++, bit++) {
+			if (readings.get(c, o)) {
+				out[start + bit / 8] |= char(1 << (bit % 8));
+			}
+		}
+	}
+}
+
+}
+
+const size_t BinaryCommandProcessor::FRAME_HEADER_SIZE;
+const uint32_t BinaryCommandProcessor::MAX_FRAME_SIZE;
+
+BinaryCommandProcessor::BinaryCommandProcessor(CommandProcessor& textProcessor)
+		: mTextProcessor(textProcessor) {
+}
+
+BinaryCommandProcessor::~BinaryCommandProcessor() {
+}
+
+uint32_t BinaryCommandProcessor::decodeFrameSize(const char* header) {
+	return getUint32(header);
+}
+
+bool BinaryCommandProcessor::isFrameComplete(const char* data, size_t size) {
+	return size >= FRAME_HEADER_SIZE && size - FRAME_HEADER_SIZE >= decodeFrameSize(data);
+}
+
+const std::string& BinaryCommandProcessor::processFrame(const char* request, size_t size) {
+
+	// leave room for the header, which is filled in when the size is known
+	mReply.assign(FRAME_HEADER_SIZE, '\0');
+
+	if (size == 0) {
+		setError(CommandProcessor::UNKNOWN_COMMAND);
+	} else {
+		uint8_t opcode = request[0];
+		const char* args = request + 1;
+		size_t argsSize = size - 1;
+
+		if (opcode != TEXT_COMMAND && opcode <= READ_FORWARD_TARGET_SENSOR_COUNTS
+				&& mTextProcessor.getSimulator() == nullptr) {
+			setError(CommandProcessor::NO_SIMULATION);
+		} else {
+
+			// decoding the arguments and encoding the reply of binary frames are part of their execution
+			LatencyTimer timer(opcode == TEXT_COMMAND ? nullptr : &mTextProcessor.getMetrics().execute);
+			try {
+				bool validArguments = true;
+				switch (opcode) {
+				case TEXT_COMMAND:
+					validArguments = opTextCommand(args, argsSize);
+					break;
+				case FINISHED:
+					validArguments = opFinished(args, argsSize);
+					break;
+				case GET_STATE:
+					validArguments = opGetState(args, argsSize);
+					break;
+				case READ_FORWARD_THREAT_SENSOR:
+					validArguments = opReadForwardThreatSensor(args, argsSize);
+					break;
+				case READ_FORWARD_TARGET_SENSOR:
+					validArguments = opReadForwardTargetSensor(args, argsSize);
+					break;
+				case READ_FORWARD_THREAT_SENSOR_FOR_OBSERVATIONS:
+					validArguments = opReadForwardThreatSensorForObservations(args, argsSize);
+					break;
+				case READ_FORWARD_TARGET_SENSOR_FOR_OBSERVATIONS:
+					validArguments = opReadForwardTargetSensorForObservations(args, argsSize);
+					break;
+				case STEP:
+					validArguments = opStep(args, argsSize);
+					break;
+				case GET_RESULTS:
+					validArguments = opGetResults(args, argsSize);
+					break;
+				case OBSERVE:
+					validArguments = opObserve(args, argsSize);
+					break;
+				case READ_FORWARD_THREAT_SENSOR_COUNTS:
+					validArguments = opReadForwardThreatSensorCounts(args, argsSize);
+					break;
+				case READ_FORWARD_TARGET_SENSOR_COUNTS:
+					validArguments = opReadForwardTargetSensorCounts(args, argsSize);
+					break;
+				default:
+					setError(CommandProcessor::UNKNOWN_COMMAND);
+				}
+
+				if (!validArguments) {
+					setError(CommandProcessor::INVALID_ARGUMENTS);
+				}
+			} catch (std::exception& e) {
+				setError(std::string("error: ") + e.what());
+			}
+		}
+	}
+
+	std::string header;
+	putUint32(header, mReply.size() - FRAME_HEADER_SIZE);
+	mReply.replace(0, FRAME_HEADER_SIZE, header);
+
+	return mReply;
+}
+
+void BinaryCommandProcessor::setError(const std::string& message) {
+	mReply.resize(FRAME_HEADER_SIZE);
+	putUint8(mReply, STATUS_ERROR);
+	mReply.append(message);
+}
+
+bool BinaryCommandProcessor::opTextCommand(const char* args, size_t size) {
+	std::string command;
+	std::string reply = mTextProcessor.executeCommand(std::string(args, size), command);
+	putUint8(mReply, (reply.compare(0, 6, "error:") == 0) ? STATUS_ERROR : STATUS_OK);
+	mReply.append(reply);
+	return true;
+}
+
+bool BinaryCommandProcessor::opFinished(const char* /*args*/, size_t size) {
+	if (size != 0) {
+		return false;
+	}
+
+	putUint8(mReply, STATUS_OK);
+	putUint8(mReply, mTextProcessor.getSimulator()->finished());
+	return true;
+}
+
+bool BinaryCommandProcessor::opGetState(const char* /*args*/, size_t size) {
+	if (size != 0) {
+		return false;
+	}
+
+	TeamState state = mTextProcessor.getSimulator()->getState();
+	putUint8(mReply, STATUS_OK);
+	putState(state);
+	return true;
+}
+
+void BinaryCommandProcessor::putState(const TeamState& state) {
+	putUint32(mReply, state.position.x);
+	putUint32(mReply, state.position.y);
+	putUint8(mReply, int8_t(state.directionX));
+	putUint8(mReply, int8_t(state.directionY));
+	putUint16(mReply, state.config.altitudeLevel);
+	putUint8(mReply, state.config.formation);
+	putUint8(mReply, state.config.ecm);
+	putUint16(mReply, state.config.ttcIncAlt);
+	putUint16(mReply, state.config.ttcDecAlt);
+	putUint16(mReply, state.config.ttcIncAlt2);
+	putUint16(mReply, state.config.ttcDecAlt2);
+}
+
+bool BinaryCommandProcessor::opReadForwardThreatSensor(const char* args, size_t size) {
+	if (size != 4) {
+		return false;
+	}
+
+	unsigned cells = mTextProcessor.limitForwardCells(getUint32(args));
+	std::vector<bool> threats = mTextProcessor.getSimulator()->readForwardThreatSensor(cells);
+	putUint8(mReply, STATUS_OK);
+	putUint32(mReply, threats.size());
+	putBits(mReply, threats);
+	return true;
+}
+
+bool BinaryCommandProcessor::opReadForwardTargetSensor(const char* args, size_t size) {
+	if (size != 4) {
+		return false;
+	}
+
+	unsigned cells = mTextProcessor.limitForwardCells(getUint32(args));
+	std::vector<bool> targets = mTextProcessor.getSimulator()->readForwardTargetSensor(cells);
+	putUint8(mReply, STATUS_OK);
+	putUint32(mReply, targets.size());
+	putBits(mReply, targets);
+	return true;
+}
+
+bool BinaryCommandProcessor::opReadForwardThreatSensorForObservations(const char* args, size_t size) {
+	if (size != 8) {
+		return false;
+	}
+
+	unsigned observationCount = getUint32(args + 4);
+	if (observationCount > SensorReadings::MAX_OBSERVATIONS) {
+		return false;
+	}
+	unsigned cells = mTextProcessor.limitForwardCells(getUint32(args), observationCount);
+	mTextProcessor.getSimulator()->readForwardThreatSensor(cells, observationCount, mReadings);
+	putUint8(mReply, STATUS_OK);
+	putUint32(mReply, mReadings.cells);
+	putUint32(mReply, observationCount);
+	putReadings(mReply, mReadings);
+	return true;
+}
+
+bool BinaryCommandProcessor::opReadForwardTargetSensorForObservations(const char* args, size_t size) {
+	if (size != 8) {
+		return false;
+	}
+
+	unsigned observationCount = getUint32(args + 4);
+	if (observationCount > SensorReadings::MAX_OBSERVATIONS) {
+		return false;
+	}
+	unsigned cells = mTextProcessor.limitForwardCells(getUint32(args), observationCount);
+	mTextProcessor.getSimulator()->readForwardTargetSensor(cells, observationCount, mReadings);
+	putUint8(mReply, STATUS_OK);
+	putUint32(mReply, mReadings.cells);
+	putUint32(mReply, observationCount);
+	putReadings(mReply, mReadings);
+	return true;
+}
+
+bool BinaryCommandProcessor::opStep(const char* args, size_t size) {
+	if (size != 9) {
+		return false;
+	}
+
+	uint8_t tactics = args[0];
+	double decisionTimeMsec = getDouble(args + 1);
+
+	bool stepResult = mTextProcessor.getSimulator()->step(TacticSet::fromMask(tactics),
+			decisionTimeMsec);
+	putUint8(mReply, STATUS_OK);
+	putUint8(mReply, stepResult);
+	return true;
+}
+
+bool BinaryCommandProcessor::opGetResults(const char* /*args*/, size_t size) {
+	if (size != 0) {
+		return false;
+	}
+
+	SimulationResults results = mTextProcessor.getSimulator()->getResults();
+	putUint8(mReply, STATUS_OK);
+	putUint8(mReply, results.destroyed);
+	putUint32(mReply, results.whereDestroyed.x);
+	putUint32(mReply, results.whereDestroyed.y);
+	putUint32(mReply, results.targetsDetected);
+	putUint8(mReply, results.missionSuccess);
+	putDouble(mReply, results.decisionTimeAvg);
+	putDouble(mReply, results.decisionTimeVar);
+	putDouble(mReply, results.decisionTimeP50);
+	putDouble(mReply, results.decisionTimeP90);
+	putDouble(mReply, results.decisionTimeP99);
+	putDouble(mReply, results.decisionTimeMax);
+	return true;
+}
+
+bool BinaryCommandProcessor::opObserve(const char* args, size_t size) {
+	if (size != 4) {
+		return false;
+	}
+
+	unsigned cells = mTextProcessor.limitForwardCells(getUint32(args));
+	Simulator* simulatorP = mTextProcessor.getSimulator();
+	TeamState state = simulatorP->getState();
+	std::vector<bool> threats = simulatorP->readForwardThreatSensor(cells);
+	std::vector<bool> targets = simulatorP->readForwardTargetSensor(cells);
+	putUint8(mReply, STATUS_OK);
+	putState(state);
+	putUint32(mReply, threats.size());
+	putBits(mReply, threats);
+	putBits(mReply, targets);
+	return true;
+}
+
+bool BinaryCommandProcessor::opReadForwardThreatSensorCounts(const char* args, size_t size) {
+	if (size != 8) {
+		return false;
+	}
+
+	unsigned cells = mTextProcessor.limitForwardCells(getUint32(args));
+	unsigned observationCount = getUint32(args + 4);
+	std::vector<unsigned> counts =
+			mTextProcessor.getSimulator()->readForwardThreatSensorCounts(cells, observationCount);
+	putUint8(mReply, STATUS_OK);
+	putUint32(mReply, counts.size());
+	for (unsigned count : counts) {
+		putUint32(mReply, count);
+	}
+	return true;
+}
+
+bool BinaryCommandProcessor::opReadForwardTargetSensorCounts(const char* args, size_t size) {
+	if (size != 8) {
+		return false;
+	}
+
+	unsigned cells = mTextProcessor.limitForwardCells(getUint32(args));
+	unsigned observationCount = getUint32(args + 4);
+	std::vector<unsigned> counts =
+			mTextProcessor.getSimulator()->readForwardTargetSensorCounts(cells, observationCount);
+	putUint8(mReply, STATUS_OK);
+	putUint32(mReply, counts.size());
+	for (unsigned count : counts) {
+		putUint32(mReply, count);
+	}
+	return true;
+}
+
+}
+}
@@ -0,0 +1,194 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+#include <dartsim/Simulator.h>
+#include "CommandProcessor.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Executes the commands of the binary protocol of the TCP interface
+ *
+ * The binary protocol is an alternative to the text protocol, which a client
+ * can switch to with the binaryProtocol text command. After the OK reply to
+ * that command, requests and replies are frames made of a 32-bit payload
+ * length followed by the payload. All the integers are little-endian.
+ *
+ * The payload of a request is the opcode byte followed by its arguments. The
+ * payload of a reply is a status byte followed by the data of the reply, or
+ * by an error message if the status is STATUS_ERROR.
+ *
+ * Sensor readings are packed bitsets, with bit i of the reading in bit
+ * (i % 8) of byte (i / 8), preceded by the number of cells sensed, which is
+ * less than requested if the cells ahead go out of the map. As in the text
+ * protocol, requests for more than CommandProcessor::MAX_READINGS readings
+ * get an error. See the opcodes for the rest of the encodings.
+ *
+ * Clients can pipeline requests, sending several frames without waiting for
+ * the replies, which are then sent in order.
+ */
+class BinaryCommandProcessor {
+public:
+	enum Opcode : uint8_t {
+
+		/** args: text command. reply: text reply of the command */
+		TEXT_COMMAND = 0,
+
+		/** args: none. reply: uint8 finished */
+		FINISHED = 1,
+
+		/**
+		 * args: none.
+		 * reply: int32 positionX, int32 positionY, int8 directionX,
+		 * int8 directionY, uint16 altitudeLevel, uint8 formation, uint8 ecm,
+		 * uint16 ttcIncAlt, uint16 ttcDecAlt, uint16 ttcIncAlt2,
+		 * uint16 ttcDecAlt2
+		 */
+		GET_STATE = 2,
+
+		/** args: uint32 cells. reply: uint32 cells, packed readings */
+		READ_FORWARD_THREAT_SENSOR = 3,
+
+		/** args: uint32 cells. reply: uint32 cells, packed readings */
+		READ_FORWARD_TARGET_SENSOR = 4,
+
+		/**
+		 * args: uint32 cells, uint32 observations, at most SensorReadings::MAX_OBSERVATIONS.
+		 * reply: uint32 cells, uint32 observations, packed readings with
+		 * observation j of cell i in bit (i * observations + j)
+		 */
+		READ_FORWARD_THREAT_SENSOR_FOR_OBSERVATIONS = 5,
+
+		/** same as READ_FORWARD_THREAT_SENSOR_FOR_OBSERVATIONS */
+		READ_FORWARD_TARGET_SENSOR_FOR_OBSERVATIONS = 6,
+
+		/**
+		 * args: uint8 tactics, float64 decisionTimeMsec, with tactics being
+		 * the mask of a TacticSet, so bit i is set to execute Tactic(i) in
+		 * IncAlt, DecAlt, IncAlt2, DecAlt2, GoTight, GoLoose, EcmOn, EcmOff.
+		 * reply: uint8 step result
+		 */
+		STEP = 7,
+
+		/**
+		 * args: none.
+		 * reply: uint8 destroyed, int32 whereDestroyedX,
+		 * int32 whereDestroyedY, uint32 targetsDetected, uint8 missionSuccess,
+		 * float64 decisionTimeAvg, float64 decisionTimeVar, float64
+		 * decisionTimeP50, float64 decisionTimeP90, float64 decisionTimeP99,
+		 * float64 decisionTimeMax
+		 */
+		GET_RESULTS = 8,
+
+		/**
+		 * args: uint32 cells.
+		 * reply: GET_STATE reply, uint32 cells, packed threat sensor
+		 * readings, packed target sensor readings
+		 */
+		OBSERVE = 9,
+
+		/**
+		 * args: uint32 cells, uint32 observations.
+		 * reply: uint32 cells, uint32 count of positive observations of
+		 * each cell
+		 */
+		READ_FORWARD_THREAT_SENSOR_COUNTS = 10,
+
+		/** same as READ_FORWARD_THREAT_SENSOR_COUNTS */
+		READ_FORWARD_TARGET_SENSOR_COUNTS = 11
+	};
+
+	enum Status : uint8_t { STATUS_OK = 0, STATUS_ERROR = 1 };
+
+	static const size_t FRAME_HEADER_SIZE = 4; /**< size of the payload length */
+	static const uint32_t MAX_FRAME_SIZE = 1 << 20; /**< max payload length of a request */
+
+	/**
+	 * @param textProcessor processor used for TEXT_COMMAND, and whose
+	 * 	simulator is used for the rest of the commands
+	 */
+	BinaryCommandProcessor(CommandProcessor& textProcessor);
+
+	/**
+	 * Decodes the payload length from a frame header
+	 *
+	 * @param header FRAME_HEADER_SIZE bytes of the header
+	 * @return payload length
+	 */
+	static uint32_t decodeFrameSize(const char* header);
+
+	/**
+	 * Checks if a buffer starts with a complete frame
+	 *
+	 * @param data buffer
+	 * @param size size of the buffer
+	 * @return true if the buffer holds the header and the whole payload
+	 */
+	static bool isFrameComplete(const char* data, size_t size);
+
+	/**
+	 * Executes a command
+	 *
+	 * @param request payload of the request frame
+	 * @param size size of the payload
+	 * @return reply frame, including its header. It is valid until the next
+	 * 	call to this method.
+	 */
+	const std::string& processFrame(const char* request, size_t size);
+
+	virtual ~BinaryCommandProcessor();
+
+private:
+	CommandProcessor& mTextProcessor;
+	std::string mReply; /**< reused for every reply to avoid allocations */
+	SensorReadings mReadings; /**< reused for every multi-observation read */
+
+	void setError(const std::string& message);
+	void putState(const TeamState& state);
+
+	bool opTextCommand(const char* args, size_t size);
+	bool opFinished(const char* args, size_t size);
+	bool opGetState(const char* args, size_t size);
+	bool opReadForwardThreatSensor(const char* args, size_t size);
+	bool opReadForwardTargetSensor(const char* args, size_t size);
+	bool opReadForwardThreatSensorForObservations(const char* args, size_t size);
+	bool opReadForwardTargetSensorForObservations(const char* args, size_t size);
+	bool opStep(const char* args, size_t size);
+	bool opGetResults(const char* args, size_t size);
+	bool opObserve(const char* args, size_t size);
+	bool opReadForwardThreatSensorCounts(const char* args, size_t size);
+	bool opReadForwardTargetSensorCounts(const char* args, size_t size);
+};
+
+}
+}
@@ -0,0 +1,530 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#include "CommandProcessor.h"
+#include <boost/tokenizer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#define DEBUG_ADAPT_INTERFACE 0
+
+using namespace json11;
+
+namespace dart {
+namespace sim {
+
+const std::string CommandProcessor::UNKNOWN_COMMAND = "error: unknown command";
+const std::string CommandProcessor::INVALID_ARGUMENTS = "error: invalid arguments count";
+const std::string CommandProcessor::NO_SIMULATION = "error: no simulation";
+const std::string CommandProcessor::COMMAND_SUCCESS = "OK";
+
+CommandProcessor::CommandProcessor(dart::sim::Simulator* simulatorP)
+		: mSimulatorP(simulatorP), mSerializeNanos(0) {
+	registerCommand("finished", std::bind(&CommandProcessor::cmdFinished, this, std::placeholders::_1));
+	registerCommand("getState", std::bind(&CommandProcessor::cmdGetState, this, std::placeholders::_1));
+	registerCommand("readForwardThreatSensor", std::bind(&CommandProcessor::cmdReadForwardThreatSensor, this, std::placeholders::_1));
+	registerCommand("readForwardTargetSensor", std::bind(&CommandProcessor::cmdReadForwardTargetSensor, this, std::placeholders::_1));
+	registerCommand("readForwardThreatSensorForObservations", std::bind(&CommandProcessor::cmdReadForwardThreatSensorForObservations, this, std::placeholders::_1));
+	registerCommand("readForwardTargetSensorForObservations", std::bind(&CommandProcessor::cmdReadForwardTargetSensorForObservations, this, std::placeholders::_1));
+	registerCommand("readForwardThreatSensorCounts", std::bind(&CommandProcessor::cmdReadForwardThreatSensorCounts, this, std::placeholders::_1));
+	registerCommand("readForwardTargetSensorCounts", std::bind(&CommandProcessor::cmdReadForwardTargetSensorCounts, this, std::placeholders::_1));
+	registerCommand("step", std::bind(&CommandProcessor::cmdStep, this, std::placeholders::_1));
+	registerCommand("getResults", std::bind(&CommandProcessor::cmdGetResults, this, std::placeholders::_1));
+	registerCommand("getScreenOutput", std::bind(&CommandProcessor::cmdGetScreenOutput, this, std::placeholders::_1));
+	registerCommand("getParameters", std::bind(&CommandProcessor::cmdGetParameters, this, std::placeholders::_1));
+	registerCommand("observe", std::bind(&CommandProcessor::cmdObserve, this, std::placeholders::_1));
+	registerCommand("batch", std::bind(&CommandProcessor::cmdBatch, this, std::placeholders::_1), false);
+	registerCommand("getMetrics", std::bind(&CommandProcessor::cmdGetMetrics, this, std::placeholders::_1), false);
+}
+
+CommandProcessor::~CommandProcessor() {
+}
+
+void CommandProcessor::setSimulator(dart::sim::Simulator* simulatorP) {
+	mSimulatorP = simulatorP;
+}
+
+dart::sim::Simulator* CommandProcessor::getSimulator() const {
+	return mSimulatorP;
+}
+
+InterfaceMetrics& CommandProcessor::getMetrics() {
+	return mMetrics;
+}
+
+unsigned CommandProcessor::limitForwardCells(unsigned cells, unsigned observations) const {
+	cells = mSimulatorP->getForwardCellsInMap(cells);
+	if (size_t(cells) * std::max(observations, 1u) > MAX_READINGS) {
+		throw std::invalid_argument("too many readings");
+	}
+	return cells;
+}
+
+unsigned CommandProcessor::parseUnsigned(const std::string& arg) {
+	if (arg.empty() || arg.size() > 10
+			|| arg.find_first_not_of("0123456789") != std::string::npos
+			|| std::stoull(arg) > std::numeric_limits<uint32_t>::max()) {
+		throw std::invalid_argument("invalid number " + arg);
+	}
+	return std::stoul(arg);
+}
+
+void CommandProcessor::registerCommand(const std::string& command, CommandHandler handler,
+		bool requiresSimulator) {
+	mCommandHandlers[command] = handler;
+	if (requiresSimulator) {
+		mSimulatorCommands.insert(command);
+	} else {
+		mSimulatorCommands.erase(command);
+	}
+}
+
+std::string CommandProcessor::processCommand(const std::string& cmd) {
+	std::string command;
+	std::string reply = executeCommand(cmd, command);
+
+	// the replies in a batch are one line each, even if they are errors
+	if (command != "batch" && reply.compare(0, 6, "error:") == 0) {
+		reply += '\n';
+	}
+	return reply;
+}
+
+std::string CommandProcessor::executeCommand(const std::string& cmd, std::string& command) {
+	typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+	std::vector<std::string> args;
+	{
+		LatencyTimer timer(&mMetrics.parse);
+		tokenizer tokens(cmd, boost::char_separator<char>(" \n[],"));
+		tokenizer::iterator it = tokens.begin();
+
+		if (it == tokens.end()) {
+			return "";
+		}
+
+		command = *it;
+		while (++it != tokens.end()) {
+#if DEBUG_ADAPT_INTERFACE
+			std::cout << "argument " << *it << std::endl;
+#endif
+			args.push_back(*it);
+		}
+	}
+
+	auto handler = mCommandHandlers.find(command);
+	if (handler == mCommandHandlers.end()) {
+		return UNKNOWN_COMMAND;
+	}
+
+	if (mSimulatorP == nullptr && mSimulatorCommands.count(command) > 0) {
+		return NO_SIMULATION;
+	}
+
+	// the serialization of the reply, including that of nested commands, is measured separately
+	const uint64_t serializeNanos = mSerializeNanos;
+	const auto start = std::chrono::steady_clock::now();
+	std::string reply;
+	try {
+		reply = handler->second(args);
+	} catch (std::exception& e) {
+		reply = std::string("error: ") + e.what();
+	}
+	const uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count();
+	const uint64_t serialization = mSerializeNanos - serializeNanos;
+	mMetrics.execute.record(elapsed > serialization ? elapsed - serialization : 0);
+
+	return reply;
+}
+
+std::string CommandProcessor::serialize(const Json& json) {
+	const auto start = std::chrono::steady_clock::now();
+	std::string result = json.dump();
+	const uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count();
+	mMetrics.serialize.record(elapsed);
+	mSerializeNanos += elapsed;
+	return result;
+}
+
+std::string CommandProcessor::cmdFinished(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.empty()) {
+		bool finished = mSimulatorP->finished();
+		result = serialize(Json(finished));
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdGetState(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.empty()) {
+		dart::sim::TeamState state = mSimulatorP->getState();
+		Json jsonState = convertTeamStateToJson(state);
+		result = serialize(jsonState);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdReadForwardThreatSensor(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.size() == 1) {
+		unsigned cells = limitForwardCells(parseUnsigned(args[0]));
+		std::vector<bool> threats = mSimulatorP->readForwardThreatSensor(cells);
+		Json jsonThreats = Json(threats);
+		result = serialize(jsonThreats);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+
+std::string CommandProcessor::cmdReadForwardTargetSensor(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.size() == 1) {
+		unsigned cells = limitForwardCells(parseUnsigned(args[0]));
+		std::vector<bool> threats = mSimulatorP->readForwardTargetSensor(cells);
+		Json jsonThreats = Json(threats);
+		result = serialize(jsonThreats);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdReadForwardTargetSensorForObservations(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.size() == 2 && parseUnsigned(args[1]) <= SensorReadings::MAX_OBSERVATIONS) {
+		unsigned observationCount = parseUnsigned(args[1]);
+		unsigned cells = limitForwardCells(parseUnsigned(args[0]), observationCount);
+		std::vector<std::vector<bool>> targets = mSimulatorP->readForwardTargetSensor(cells, observationCount);
+		Json jsonThreats = Json(targets);
+		result = serialize(jsonThreats);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdReadForwardThreatSensorForObservations(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.size() == 2 && parseUnsigned(args[1]) <= SensorReadings::MAX_OBSERVATIONS) {
+		unsigned observationCount = parseUnsigned(args[1]);
+		unsigned cells = limitForwardCells(parseUnsigned(args[0]), observationCount);
+		std::vector<std::vector<bool>> threats = mSimulatorP->readForwardThreatSensor(cells, observationCount);
+		Json jsonThreats = Json(threats);
+		result = serialize(jsonThreats);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdReadForwardThreatSensorCounts(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.size() == 2) {
+		unsigned cells = limitForwardCells(parseUnsigned(args[0]));
+		unsigned observationCount = parseUnsigned(args[1]);
+		std::vector<unsigned> counts = mSimulatorP->readForwardThreatSensorCounts(cells, observationCount);
+		result = serialize(Json(std::vector<int>(counts.begin(), counts.end())));
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdReadForwardTargetSensorCounts(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.size() == 2) {
+		unsigned cells = limitForwardCells(parseUnsigned(args[0]));
+		unsigned observationCount = parseUnsigned(args[1]);
+		std::vector<unsigned> counts = mSimulatorP->readForwardTargetSensorCounts(cells, observationCount);
+		result = serialize(Json(std::vector<int>(counts.begin(), counts.end())));
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdStep(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.empty()) {
+		return INVALID_ARGUMENTS;
+	}
+
+	dart::sim::TacticSet tacticSet;
+	unsigned index = 0;
+	std::string decisionTimeMsecStr = args[args.size() - 1];
+	double decisionTimeMsec = atof(decisionTimeMsecStr.c_str());
+
+	while (index < args.size() - 1) {
+		std::string tactic = args[index];
+		if ( tactic[0] == '"' ) {
+		    tactic.erase( 0, 1 ); // erase the first character
+		    tactic.erase( tactic.size() - 1 ); // erase the last character
+		}
+#if DEBUG_ADAPT_INTERFACE
+		std::cout << "tactic = " << tactic << std::endl;
+#endif
+		Tactic parsedTactic = Tactic::INC_ALTITUDE;
+		if (!findTactic(tactic.data(), tactic.size(), parsedTactic)) {
+			throw std::runtime_error("unknown tactic " + tactic);
+		}
+		tacticSet.insert(parsedTactic);
+
+		++index;
+	}
+
+	bool stepResult = mSimulatorP->step(tacticSet, decisionTimeMsec);
+	result = serialize(Json(stepResult));
+
+	return result;
+}
+
+std::string CommandProcessor::cmdGetResults(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.empty()) {
+		dart::sim::SimulationResults simResults = mSimulatorP->getResults();
+		Json jsonSimResults = convertSimulationResultsToJson(simResults);
+		result = serialize(jsonSimResults);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdGetScreenOutput(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.empty()) {
+		std::string output = mSimulatorP->getScreenOutput();
+		Json jsonOutput = Json(output);
+		result = serialize(jsonOutput);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdGetParameters(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.empty()) {
+		dart::sim::SimulationParams simParams = mSimulatorP->getParameters();
+		Json jsonSimParams = convertSimulationParamsToJson(simParams);
+		result = serialize(jsonSimParams);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdObserve(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	if (args.size() == 1) {
+		unsigned cells = limitForwardCells(parseUnsigned(args[0]));
+		dart::sim::TeamState state = mSimulatorP->getState();
+		std::vector<bool> threats = mSimulatorP->readForwardThreatSensor(cells);
+		std::vector<bool> targets = mSimulatorP->readForwardTargetSensor(cells);
+		Json jsonObservation = Json::object {
+			{"state", convertTeamStateToJson(state)},
+			{"threats", Json(threats)},
+			{"targets", Json(targets)}
+		};
+		result = serialize(jsonObservation);
+	} else {
+		result = INVALID_ARGUMENTS;
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdBatch(const std::vector<std::string>& args) {
+	std::string result = "";
+
+	// the tokenizer keeps the separators of the commands attached to the arguments
+	std::string cmd;
+	std::string command;
+	for (const auto& arg : args) {
+		for (char c : arg) {
+			if (c == ';') {
+				std::string reply = executeCommand(cmd, command);
+				if (!reply.empty()) {
+					result += reply + '\n';
+				}
+				cmd.clear();
+			} else {
+				cmd += c;
+			}
+		}
+		cmd += ' ';
+	}
+
+	std::string reply = executeCommand(cmd, command);
+	if (!reply.empty()) {
+		result += reply + '\n';
+	}
+
+	// the last line terminator is added when the reply is sent
+	if (!result.empty()) {
+		result.pop_back();
+	}
+
+	return result;
+}
+
+std::string CommandProcessor::cmdGetMetrics(const std::vector<std::string>& args) {
+	if (!args.empty()) {
+		return INVALID_ARGUMENTS;
+	}
+
+	Json::object jsonMetrics {
+		{"interface", Json::object {
+			{"receive", convertHistogramToJson(mMetrics.receive)},
+			{"parse", convertHistogramToJson(mMetrics.parse)},
+			{"execute", convertHistogramToJson(mMetrics.execute)},
+			{"serialize", convertHistogramToJson(mMetrics.serialize)},
+			{"send", convertHistogramToJson(mMetrics.send)}
+		}}
+	};
+
+	if (mSimulatorP) {
+		SimulatorMetrics simMetrics = mSimulatorP->getMetrics();
+		jsonMetrics["simulator"] = Json::object {
+			{"sensing", convertHistogramToJson(simMetrics.sensing)},
+			{"tactics", convertHistogramToJson(simMetrics.tactics)},
+			{"threats", convertHistogramToJson(simMetrics.threats)},
+			{"targets", convertHistogramToJson(simMetrics.targets)}
+		};
+	}
+
+	return serialize(jsonMetrics);
+}
+
+Json CommandProcessor::convertHistogramToJson(const LatencyHistogram& histogram) const {
+	Json jsonHistogram = Json::object {
+		{"count", double(histogram.getCount())},
+		{"mean", histogram.getMean()},
+		{"p50", double(histogram.getQuantile(0.5))},
+		{"p90", double(histogram.getQuantile(0.9))},
+		{"p99", double(histogram.getQuantile(0.99))},
+		{"max", double(histogram.getMax())}
+	};
+
+	return jsonHistogram;
+}
+
+Json CommandProcessor::convertSimulationResultsToJson(const dart::sim::SimulationResults& simResults) const {
+	auto reported = [](double value) { return std::isnan(value) ? -1.0 : value; };
+
+	Json jsonState = Json::object {
+		{"destroyed", simResults.destroyed},
+		{"destruction positionX", simResults.whereDestroyed.x},
+		{"destruction positionY", simResults.whereDestroyed.y},
+		{"targetsDetected", int(simResults.targetsDetected)},
+		{"missionSuccess", simResults.missionSuccess},
+		{"decisionTimeAvg", reported(simResults.decisionTimeAvg)},
+		{"decisionTimeVar", reported(simResults.decisionTimeVar)},
+		{"decisionTimeP50", reported(simResults.decisionTimeP50)},
+		{"decisionTimeP90", reported(simResults.decisionTimeP90)},
+		{"decisionTimeP99", reported(simResults.decisionTimeP99)},
+		{"decisionTimeMax", reported(simResults.decisionTimeMax)}
+	};
+
+	return jsonState;
+}
+
+Json CommandProcessor::convertTeamStateToJson(const dart::sim::TeamState& state) const {
+	Json jsonState = Json::object {
+		{"positionX", state.position.x},
+		{"positionY", state.position.y},
+		{"directionX", state.directionX},
+		{"directionY", state.directionY},
+		{"altitudeLevel", int(state.config.altitudeLevel)},
+		{"formation", state.config.formation},
+		{"ecm", state.config.ecm},
+		{"ttcIncAlt", int(state.config.ttcIncAlt)},
+		{"ttcDecAlt", int(state.config.ttcDecAlt)},
+		{"ttcIncAlt2", int(state.config.ttcIncAlt2)},
+		{"ttcDecAlt2", int(state.config.ttcDecAlt2)}
+	};
+
+	return jsonState;
+}
+
+Json CommandProcessor::convertSimulationParamsToJson(const dart::sim::SimulationParams& simParams) const {
+	Json jsonState = Json::object {
+			{"mapSize", int(simParams.mapSize)},
+			{"squareMap", bool(simParams.squareMap)},
+			{"altitudeLevels", int(simParams.altitudeLevels)},
+			{"changeAltitudeLatencyPeriods", int(simParams.changeAltitudeLatencyPeriods)},
+			{"optimalityTest", bool(simParams.optimalityTest)},
+			{"threatSensorFPR", double(simParams.longRangeSensor.threatSensorFPR)},
+			{"threatSensorFNR", double(simParams.longRangeSensor.threatSensorFNR)},
+			{"targetSensorFPR", double(simParams.longRangeSensor.targetSensorFPR)},
+			{"targetSensorFNR", double(simParams.longRangeSensor.targetSensorFNR)},
+			{"targetDetectionFormationFactor", double(simParams.downwardLookingSensor.targetDetectionFormationFactor)},
+			{"targetSensorRange", int(simParams.downwardLookingSensor.targetSensorRange)},
+			{"destructionFormationFactor", double(simParams.threat.destructionFormationFactor)},
+			{"threatRange", int(simParams.threat.threatRange)},
+		};
+
+	return jsonState;
+}
+}
+}
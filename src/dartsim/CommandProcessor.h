@@ -0,0 +1,184 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+#include <dartsim/LatencyHistogram.h>
+#include <dartsim/Simulator.h>
+#include <json11.hpp>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Latencies in nanoseconds of the phases of serving the commands of a client
+ */
+struct InterfaceMetrics {
+	LatencyHistogram receive;   /**< waiting for and reading a command */
+	LatencyHistogram parse;     /**< tokenizing a command line */
+	LatencyHistogram execute;   /**< running a command, excluding the serialization of its reply */
+	LatencyHistogram serialize; /**< encoding a reply as JSON */
+	LatencyHistogram send;      /**< writing replies to the socket */
+};
+
+/**
+ * Executes the commands of the TCP interface on a simulator
+ *
+ * Commands are lines of text with the command name followed by its
+ * arguments, and each command produces a one-line reply. Error replies,
+ * which start with "error:", are sent followed by an empty line. Several
+ * commands separated by ';' can be sent in one line with the batch command,
+ * which replies with the lines of the replies of each command.
+ */
+class CommandProcessor {
+public:
+	using CommandHandler = std::function<std::string(const std::vector<std::string>&)>;
+
+	static const std::string UNKNOWN_COMMAND;
+	static const std::string INVALID_ARGUMENTS;
+	static const std::string NO_SIMULATION;
+	static const std::string COMMAND_SUCCESS;
+
+	/**
+	 * Maximum number of sensor readings in the reply to a command
+	 */
+	static const size_t MAX_READINGS = 1 << 24;
+
+	/**
+	 * @param simulatorP simulator on which the commands are executed. It can be
+	 * 	nullptr if it is going to be set later with setSimulator()
+	 */
+	CommandProcessor(dart::sim::Simulator* simulatorP = nullptr);
+
+	void setSimulator(dart::sim::Simulator* simulatorP);
+
+	dart::sim::Simulator* getSimulator() const;
+
+	/**
+	 * Adds (or replaces) the handler of a command
+	 *
+	 * @param command name of the command
+	 * @param handler function that executes the command and returns the reply
+	 * @param requiresSimulator if true, the command is rejected when there
+	 * 	is no simulator
+	 */
+	void registerCommand(const std::string& command, CommandHandler handler,
+			bool requiresSimulator = true);
+
+	/**
+	 * Executes a command
+	 *
+	 * @param cmd command line without the line terminator
+	 * @return reply without the line terminator. It is empty if the command
+	 * 	line was empty, in which case no reply should be sent. Error
+	 * 	replies, except in a batch, have an extra line terminator, so that
+	 * 	they are followed by an empty line, which is how clients have
+	 * 	always found where they end.
+	 */
+	std::string processCommand(const std::string& cmd);
+
+	/**
+	 * Executes a command whose reply is delimited by other means, such as
+	 * a frame of the binary protocol or a line of a batch reply
+	 *
+	 * @param cmd command line without the line terminator
+	 * @param command set to the name of the command
+	 * @return reply as processCommand() returns it, but without the extra
+	 * 	line terminator of errors
+	 */
+	std::string executeCommand(const std::string& cmd, std::string& command);
+
+	/**
+	 * Limits the cells that a command reads in front of the team to those
+	 * inside the map, which the sensors read the same way as the ones
+	 * outside
+	 *
+	 * @param cells number of cells requested
+	 * @param observations number of observations of each cell in the reply
+	 * @return number of cells to read
+	 * @throws std::invalid_argument if the reply would have more than
+	 * 	MAX_READINGS readings
+	 */
+	unsigned limitForwardCells(unsigned cells, unsigned observations = 1) const;
+
+	/**
+	 * @return latencies of serving the commands. The server records the
+	 * 	receive and send phases, since they are outside the processor.
+	 */
+	InterfaceMetrics& getMetrics();
+
+	virtual ~CommandProcessor();
+
+private:
+	dart::sim::Simulator* mSimulatorP;
+	std::map<std::string, CommandHandler> mCommandHandlers;
+	std::set<std::string> mSimulatorCommands; /**< commands that require a simulator */
+	InterfaceMetrics mMetrics;
+	uint64_t mSerializeNanos; /**< total time spent in serialize(), to exclude it from execution */
+
+	/**
+	 * Parses a numeric argument
+	 *
+	 * @throws std::invalid_argument if it is not a decimal number that
+	 * 	fits in 32 bits
+	 */
+	static unsigned parseUnsigned(const std::string& arg);
+
+	/**
+	 * Encodes a reply, measuring the time it takes
+	 */
+	std::string serialize(const json11::Json& json);
+	json11::Json convertHistogramToJson(const LatencyHistogram& histogram) const;
+
+	json11::Json convertTeamStateToJson(const dart::sim::TeamState& state) const;
+	json11::Json convertSimulationResultsToJson(const dart::sim::SimulationResults& simResults) const;
+	json11::Json convertSimulationParamsToJson(const dart::sim::SimulationParams& simResults) const;
+
+	std::string cmdFinished(const std::vector<std::string>& args);
+	std::string cmdGetState(const std::vector<std::string>& args);
+	std::string cmdReadForwardThreatSensor(const std::vector<std::string>& args);
+	std::string cmdReadForwardTargetSensor(const std::vector<std::string>& args);
+	std::string cmdReadForwardThreatSensorForObservations(const std::vector<std::string>& args);
+	std::string cmdReadForwardTargetSensorForObservations(const std::vector<std::string>& args);
+	std::string cmdReadForwardThreatSensorCounts(const std::vector<std::string>& args);
+	std::string cmdReadForwardTargetSensorCounts(const std::vector<std::string>& args);
+	std::string cmdStep(const std::vector<std::string>& args);
+	std::string cmdGetResults(const std::vector<std::string>& args);
+	std::string cmdGetScreenOutput(const std::vector<std::string>& args);
+	std::string cmdGetParameters(const std::vector<std::string>& args);
+	std::string cmdObserve(const std::vector<std::string>& args);
+	std::string cmdBatch(const std::vector<std::string>& args);
+	std::string cmdGetMetrics(const std::vector<std::string>& args);
+};
+
+}
+}
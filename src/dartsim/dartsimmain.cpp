@@ -28,16 +28,94 @@
 #include <dartsim/Simulator.h>
 #include <iostream>
 #include <string.h>
+#include <getopt.h>
 #include "AdaptInterface.h"
+#include "AdaptServer.h"
 
 using namespace std;
 using namespace dart::sim;
 
+enum SERVER_ARGS {
+	SERVER,
+	PORT,
+	THREADS
+};
+
+static struct option server_long_options[] = {
+	{"server", no_argument, 0,  SERVER },
+	{"port", required_argument, 0,  PORT },
+	{"threads", required_argument, 0,  THREADS },
+    {0, 0, 0, 0 }
+};
+
+static void usage() {
+	cout << "usage: dartsim [simulator options]" << endl;
+	cout << "       dartsim --server [--port=value] [--threads=value]" << endl;
+	Simulator::usage();
+}
+
+/**
+ * Runs a server that hosts multiple simulations, one per client connection
+ */
+static void runServer(int argc, char** argv) {
+	unsigned port = 5418;
+	unsigned threads = 0;
+
+	while (1) {
+		int option_index = 0;
+
+		auto c = getopt_long(argc, argv, "", server_long_options, &option_index);
+
+		if (c == -1) {
+			break;
+		}
+
+		switch (c) {
+		case SERVER:
+			break;
+		case PORT:
+			port = atoi(optarg);
+			break;
+		case THREADS:
+			threads = atoi(optarg);
+			break;
+		default:
+			usage();
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (optind < argc) {
+		usage();
+		exit(EXIT_FAILURE);
+	}
+
+	cout << "Simulation server listening on port " << port << endl;
+
+	AdaptServer server(port);
+	server.run(threads);
+}
+
 int main(int argc, char** argv) {
 
-	Simulator *sim = Simulator::createInstance(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "--server") == 0) {
+		runServer(argc, argv);
+		return 0;
+	}
+
+	SimulationParams simParams;
+	ScenarioParams scenarioParams;
+	Simulator *sim = nullptr;
+	if (Simulator::parseArguments(argc, argv, simParams, scenarioParams)) {
+
+		// unless told otherwise, log the events of the simulation as it runs
+		if (!simParams.eventSink) {
+			simParams.eventSink = make_shared<TextEventSink>(cout, 0);
+		}
+		sim = Simulator::createInstance(simParams, scenarioParams);
+	}
 	if (!sim) {
-		Simulator::usage();
+		usage();
 		exit(EXIT_FAILURE);
 	}
 
@@ -0,0 +1,180 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#include <dartsim/BatchRunner.h>
+#include "SimulatorImpl.h"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+namespace dart {
+namespace sim {
+
+namespace {
+
+/*
+ * Serializes the events of the missions that run concurrently
+ */
+class LockedEventSink : public EventSink {
+public:
+	LockedEventSink(shared_ptr<EventSink> pSink) : pSink(pSink) {}
+
+	void tacticExecuted(const Coordinate& position, Tactic tactic) override {
+		lock_guard<mutex> lock(sinkMutex);
+		pSink->tacticExecuted(position, tactic);
+	}
+
+	void targetDetected(const Coordinate& position) override {
+		lock_guard<mutex> lock(sinkMutex);
+		pSink->targetDetected(position);
+	}
+
+	void teamDestroyed(const Coordinate& position) override {
+		lock_guard<mutex> lock(sinkMutex);
+		pSink->teamDestroyed(position);
+	}
+
+	void flush() override {
+		lock_guard<mutex> lock(sinkMutex);
+		pSink->flush();
+	}
+
+private:
+	shared_ptr<EventSink> pSink;
+	mutex sinkMutex;
+};
+
+}
+
+BatchRunner::BatchRunner(const SimulationParams& simParams,
+		const ScenarioParams& scenarioParams, MissionFunction mission)
+	: simParams(simParams), scenarioParams(scenarioParams), mission(mission)
+{
+	if (this->simParams.eventSink) {
+		this->simParams.eventSink = make_shared<LockedEventSink>(this->simParams.eventSink);
+	}
+}
+
+SimulationResults BatchRunner::runMission(int seed, LatencyHistogram& decisionTimes) {
+	ScenarioParams missionScenario = scenarioParams;
+	missionScenario.seeded = true;
+	missionScenario.seed = seed;
+
+	unique_ptr<Simulator> sim(Simulator::createInstance(simParams, missionScenario));
+	if (!sim) {
+		throw invalid_argument("invalid simulation parameters");
+	}
+
+	mission(*sim);
+	auto pSim = dynamic_cast<SimulatorImpl*>(sim.get());
+	if (pSim) {
+		decisionTimes.merge(*pSim->decisionTimeHistogram);
+	}
+	return sim->getResults();
+}
+
+BatchResults BatchRunner::run(int firstSeed, unsigned numOfMissions, unsigned numOfThreads) {
+	BatchResults results;
+	results.seeds.resize(numOfMissions);
+	results.missions.resize(numOfMissions);
+
+	if (numOfThreads == 0) {
+		numOfThreads = max(1u, thread::hardware_concurrency());
+	}
+	numOfThreads = min(numOfThreads, numOfMissions);
+
+	atomic<unsigned> nextMission(0);
+	LatencyHistogram decisionTimes; // merged by the workers without locking
+	exception_ptr error;
+	mutex errorMutex;
+
+	auto worker = [&]() {
+		unsigned missionIndex;
+		while ((missionIndex = nextMission++) < numOfMissions) {
+			int seed = firstSeed + missionIndex;
+			results.seeds[missionIndex] = seed;
+			try {
+				results.missions[missionIndex] = runMission(seed, decisionTimes);
+			} catch (...) {
+				lock_guard<mutex> lock(errorMutex);
+				if (!error) {
+					error = current_exception();
+				}
+				nextMission = numOfMissions; // stop the other workers
+			}
+		}
+	};
+
+	vector<thread> threads;
+	for (unsigned t = 0; t < numOfThreads; t++) {
+		threads.emplace_back(worker);
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	if (error) {
+		rethrow_exception(error);
+	}
+
+	/* aggregate results */
+	double targetsDetected = 0.0;
+	double decisionTime = 0.0;
+	for (const auto& missionResults : results.missions) {
+		if (missionResults.destroyed) {
+			results.destroyed++;
+		}
+		if (missionResults.missionSuccess) {
+			results.missionSuccesses++;
+		}
+		targetsDetected += missionResults.targetsDetected;
+		decisionTime += missionResults.decisionTimeAvg;
+	}
+	if (numOfMissions > 0) {
+		results.targetsDetectedAvg = targetsDetected / numOfMissions;
+		results.decisionTimeAvg = decisionTime / numOfMissions;
+	}
+	const double NSEC_PER_MSEC = 1e6;
+	results.decisionTimeP50 = decisionTimes.getQuantile(0.5) / NSEC_PER_MSEC;
+	results.decisionTimeP90 = decisionTimes.getQuantile(0.9) / NSEC_PER_MSEC;
+	results.decisionTimeP99 = decisionTimes.getQuantile(0.99) / NSEC_PER_MSEC;
+	results.decisionTimeMax = decisionTimes.getMax() / NSEC_PER_MSEC;
+
+	return results;
+}
+
+BatchRunner::~BatchRunner() {
+}
+
+} /* namespace sim */
+} /* namespace dart */
@@ -0,0 +1,322 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+#include <dartsim/BatchSimulator.h>
+#include "SimulatorImpl.h"
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+
+namespace dart {
+namespace sim {
+
+BatchSimulator::BatchSimulator(const SimulationParams& simParams,
+		const ScenarioParams& scenarioParams,
+		int firstSeed, unsigned numOfMissions)
+	: numOfMissions(numOfMissions),
+	  routeIndex(numOfMissions, 0),
+	  positionX(numOfMissions),
+	  positionY(numOfMissions),
+	  altitudeLevel(numOfMissions),
+	  tightFormation(numOfMissions),
+	  ecm(numOfMissions),
+	  ttcIncAlt(numOfMissions),
+	  ttcDecAlt(numOfMissions),
+	  ttcIncAlt2(numOfMissions),
+	  ttcDecAlt2(numOfMissions),
+	  destroyed(numOfMissions, false),
+	  targetsDetected(numOfMissions, 0),
+	  threatStreamKeys(numOfMissions),
+	  threatStreamCounters(numOfMissions),
+	  targetStreamKeys(numOfMissions),
+	  targetStreamCounters(numOfMissions),
+	  active(numOfMissions),
+	  objectPresent(numOfMissions),
+	  threshold(numOfMissions)
+{
+	if (numOfMissions == 0) {
+		throw invalid_argument("a batch needs at least one mission");
+	}
+
+	SimulationParams missionParams = simParams;
+	missionParams.eventSink.reset();
+	missionParams.recordTrajectory = false;
+
+	/*
+	 * the scenarios are generated by creating a simulator for each mission,
+	 * so that they are exactly the same that independent simulators use
+	 */
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		ScenarioParams missionScenario = scenarioParams;
+		missionScenario.seeded = true;
+		missionScenario.seed = firstSeed + m;
+
+		unique_ptr<Simulator> sim(Simulator::createInstance(missionParams, missionScenario));
+		auto pSim = dynamic_cast<SimulatorImpl*>(sim.get());
+		if (!pSim) {
+			throw invalid_argument("invalid simulation parameters");
+		}
+
+		if (m == 0) {
+			params = pSim->params;
+			missionSuccessThreshold = pSim->MISSION_SUCCESS_THRESHOLD;
+			pThreat = pSim->pThreatSim->clone();
+			pTargetSensor = pSim->pTargetSensor->clone();
+
+			routeGeometry = pSim->routeGeometry;
+			for (const auto& point : *pSim->route) {
+				routeX.push_back(point.x);
+				routeY.push_back(point.y);
+			}
+		}
+
+		threatEnvs.push_back(pSim->threatEnv);
+		targetEnvs.push_back(pSim->targetEnv);
+		fwdThreatSensors.push_back(make_unique<Sensor>(*pSim->pFwdThreatSensor));
+		fwdTargetSensors.push_back(make_unique<Sensor>(*pSim->pFwdTargetSensor));
+
+		const TeamConfiguration& config = pSim->currentConfig;
+		positionX[m] = pSim->position.x;
+		positionY[m] = pSim->position.y;
+		altitudeLevel[m] = config.altitudeLevel;
+		tightFormation[m] = (config.formation == TeamConfiguration::Formation::TIGHT);
+		ecm[m] = config.ecm;
+		ttcIncAlt[m] = config.ttcIncAlt;
+		ttcDecAlt[m] = config.ttcDecAlt;
+		ttcIncAlt2[m] = config.ttcIncAlt2;
+		ttcDecAlt2[m] = config.ttcDecAlt2;
+
+		RandomStream threatStream = pSim->seedContext.getStream(SeedContext::THREAT);
+		threatStreamKeys[m] = threatStream.getKey();
+		threatStreamCounters[m] = threatStream.getCounter();
+		RandomStream targetStream = pSim->seedContext.getStream(SeedContext::TARGET_SENSOR);
+		targetStreamKeys[m] = targetStream.getKey();
+		targetStreamCounters[m] = targetStream.getCounter();
+	}
+
+	/* precompute the thresholds for the altitudes the team can normally reach */
+	tableAltitudes = params.altitudeLevels + 3;
+	destructionThresholds.resize(tableAltitudes * 4);
+	detectionThresholds.resize(tableAltitudes * 4);
+	for (unsigned altitude = 0; altitude < tableAltitudes; altitude++) {
+		for (unsigned tight = 0; tight < 2; tight++) {
+			for (unsigned ecmOn = 0; ecmOn < 2; ecmOn++) {
+				TeamConfiguration config = { altitude,
+						tight ? TeamConfiguration::Formation::TIGHT : TeamConfiguration::Formation::LOOSE,
+						bool(ecmOn), 0, 0, 0, 0 };
+				size_t index = (altitude * 2 + tight) * 2 + ecmOn;
+				destructionThresholds[index] =
+						RandomStream::getThreshold(pThreat->getProbabilityOfDestruction(config));
+				detectionThresholds[index] =
+						RandomStream::getThreshold(pTargetSensor->getProbabilityOfDetection(config));
+			}
+		}
+	}
+}
+
+unsigned BatchSimulator::size() const {
+	return numOfMissions;
+}
+
+bool BatchSimulator::finished(unsigned mission) const {
+	return destroyed[mission] || routeIndex[mission] >= routeX.size();
+}
+
+bool BatchSimulator::finished() const {
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		if (!finished(m)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TeamConfiguration BatchSimulator::getConfiguration(unsigned mission) const {
+	return { altitudeLevel[mission],
+		tightFormation[mission] ? TeamConfiguration::Formation::TIGHT : TeamConfiguration::Formation::LOOSE,
+		bool(ecm[mission]),
+		ttcIncAlt[mission], ttcDecAlt[mission], ttcIncAlt2[mission], ttcDecAlt2[mission] };
+}
+
+size_t BatchSimulator::getTableIndex(unsigned mission) const {
+	return (size_t(altitudeLevel[mission]) * 2 + tightFormation[mission]) * 2 + ecm[mission];
+}
+
+void BatchSimulator::getState(unsigned mission, TeamState& state) const {
+	state.position = Coordinate(positionX[mission], positionY[mission]);
+	state.config = getConfiguration(mission);
+	const Coordinate direction = routeGeometry->getDirection(routeIndex[mission]);
+	state.directionX = direction.x;
+	state.directionY = direction.y;
+}
+
+unsigned BatchSimulator::readForwardSensor(unsigned mission, const RealEnvironment& environment,
+		Sensor& sensor, unsigned cells, bool* sensed) {
+	const auto ray = routeGeometry->getForwardRay(routeIndex[mission], cells);
+	RouteGeometry::visitRay(ray, environment, [&](unsigned c, bool isObject) {
+		sensed[c] = sensor.sense(isObject);
+	});
+
+	return ray.length;
+}
+
+unsigned BatchSimulator::readForwardThreatSensor(unsigned mission, unsigned cells, bool* sensed) {
+	return readForwardSensor(mission, *threatEnvs[mission], *fwdThreatSensors[mission], cells, sensed);
+}
+
+unsigned BatchSimulator::readForwardTargetSensor(unsigned mission, unsigned cells, bool* sensed) {
+	return readForwardSensor(mission, *targetEnvs[mission], *fwdTargetSensors[mission], cells, sensed);
+}
+
+void BatchSimulator::step(const std::vector<TacticSet>& tactics) {
+	if (tactics.size() != numOfMissions) {
+		throw invalid_argument("there must be tactics for each mission");
+	}
+
+	const uint32_t routeSize = routeX.size();
+	const unsigned latency = params.changeAltitudeLatencyPeriods;
+
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		active[m] = !destroyed[m] && routeIndex[m] < routeSize;
+	}
+
+	/* execute tactics, as SimulatorImpl::executeTactics() does */
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		const TacticSet t = tactics[m];
+		if (!active[m] || t.empty()) {
+			continue;
+		}
+		if (latency > 0) {
+			ttcIncAlt[m] = t.contains(Tactic::INC_ALTITUDE) ? latency : ttcIncAlt[m];
+			ttcDecAlt[m] = t.contains(Tactic::DEC_ALTITUDE) ? latency : ttcDecAlt[m];
+			ttcIncAlt2[m] = t.contains(Tactic::INC_ALTITUDE2) ? latency : ttcIncAlt2[m];
+			ttcDecAlt2[m] = t.contains(Tactic::DEC_ALTITUDE2) ? latency : ttcDecAlt2[m];
+		} else {
+			altitudeLevel[m] = altitudeLevel[m]
+					+ t.contains(Tactic::INC_ALTITUDE)
+					+ 2 * t.contains(Tactic::INC_ALTITUDE2)
+					- t.contains(Tactic::DEC_ALTITUDE)
+					- 2 * t.contains(Tactic::DEC_ALTITUDE2);
+		}
+		if (t.contains(Tactic::GO_TIGHT) || t.contains(Tactic::GO_LOOSE)) {
+			tightFormation[m] = t.contains(Tactic::GO_TIGHT);
+		}
+		if (t.contains(Tactic::ECM_ON) || t.contains(Tactic::ECM_OFF)) {
+			ecm[m] = t.contains(Tactic::ECM_ON);
+		}
+	}
+
+	/* simulate threats */
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		objectPresent[m] = active[m]
+				&& threatEnvs[m]->isObjectAt(Coordinate(positionX[m], positionY[m]));
+	}
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		if (altitudeLevel[m] < tableAltitudes) {
+			threshold[m] = destructionThresholds[getTableIndex(m)];
+		} else {
+			threshold[m] = RandomStream::getThreshold(
+					pThreat->getProbabilityOfDestruction(getConfiguration(m)));
+		}
+	}
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		// a random number is only drawn if there is a threat
+		uint64_t random = RandomStream(threatStreamKeys[m], threatStreamCounters[m])()
+				>> RandomStream::UNIFORM_SHIFT;
+		threatStreamCounters[m] += objectPresent[m];
+		destroyed[m] = destroyed[m] || (objectPresent[m] && random <= threshold[m]);
+		active[m] = active[m] && !destroyed[m];
+	}
+
+	/* simulate target detection */
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		objectPresent[m] = active[m]
+				&& targetEnvs[m]->isObjectAt(Coordinate(positionX[m], positionY[m]));
+	}
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		if (altitudeLevel[m] < tableAltitudes) {
+			threshold[m] = detectionThresholds[getTableIndex(m)];
+		} else {
+			threshold[m] = RandomStream::getThreshold(
+					pTargetSensor->getProbabilityOfDetection(getConfiguration(m)));
+		}
+	}
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		uint64_t random = RandomStream(targetStreamKeys[m], targetStreamCounters[m])()
+				>> RandomStream::UNIFORM_SHIFT;
+		targetStreamCounters[m] += objectPresent[m];
+		targetsDetected[m] += (objectPresent[m] && random <= threshold[m]);
+	}
+
+	/* system evolution */
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		routeIndex[m] += active[m];
+		if (active[m] && routeIndex[m] < routeSize) {
+			positionX[m] = routeX[routeIndex[m]];
+			positionY[m] = routeY[routeIndex[m]];
+		}
+	}
+
+	/* update tactic progress */
+	for (unsigned m = 0; m < numOfMissions; m++) {
+		if (!active[m]) {
+			continue;
+		}
+		if (ttcIncAlt[m] > 0 && --ttcIncAlt[m] == 0) {
+			altitudeLevel[m] += 1;
+		}
+		if (ttcDecAlt[m] > 0 && --ttcDecAlt[m] == 0) {
+			altitudeLevel[m] -= 1;
+		}
+		if (ttcIncAlt2[m] > 0 && --ttcIncAlt2[m] == 0) {
+			altitudeLevel[m] += 2;
+		}
+		if (ttcDecAlt2[m] > 0 && --ttcDecAlt2[m] == 0) {
+			altitudeLevel[m] -= 2;
+		}
+	}
+}
+
+SimulationResults BatchSimulator::getResults(unsigned mission) const {
+	SimulationResults results;
+	results.destroyed = destroyed[mission];
+	results.targetsDetected = targetsDetected[mission];
+	results.whereDestroyed = Coordinate(positionX[mission], positionY[mission]);
+	results.missionSuccess = !destroyed[mission] && targetsDetected[mission] >= missionSuccessThreshold;
+	results.decisionTimeAvg = results.decisionTimeVar = results.decisionTimeP50
+			= results.decisionTimeP90 = results.decisionTimeP99 = results.decisionTimeMax
+			= std::numeric_limits<double>::quiet_NaN();
+	return results;
+}
+
+BatchSimulator::~BatchSimulator() {
+}
+
+} /* namespace sim */
+} /* namespace dart */
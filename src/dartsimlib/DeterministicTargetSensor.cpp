@@ -47,6 +47,10 @@ double DeterministicTargetSensor::getProbabilityOfDetection(const TeamConfigurat
 	return probOfDetection;
 }
 
+std::shared_ptr<TargetSensor> DeterministicTargetSensor::clone() const {
+	return std::make_shared<DeterministicTargetSensor>(*this);
+}
+
 DeterministicTargetSensor::~DeterministicTargetSensor() {
 }
 
@@ -37,6 +37,7 @@ class DeterministicTargetSensor: public TargetSensor {
 public:
 	using TargetSensor::TargetSensor;
 	virtual double getProbabilityOfDetection(const TeamConfiguration& config) ;//override;
+	virtual std::shared_ptr<TargetSensor> clone() const override;
 	virtual ~DeterministicTargetSensor();
 };
 
@@ -48,6 +48,10 @@ double DeterministicThreat::getProbabilityOfDestruction(const TeamConfiguration&
 	return probOfDetection;
 }
 
+std::shared_ptr<Threat> DeterministicThreat::clone() const {
+	return std::make_shared<DeterministicThreat>(*this);
+}
+
 DeterministicThreat::~DeterministicThreat() {
 }
 
@@ -37,6 +37,7 @@ class DeterministicThreat: public Threat {
 public:
 	using Threat::Threat;
 	virtual double getProbabilityOfDestruction(const TeamConfiguration& config) override;
+	virtual std::shared_ptr<Threat> clone() const override;
 	virtual ~DeterministicThreat();
 };
 
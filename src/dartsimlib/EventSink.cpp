@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#include <dartsim/EventSink.h>
+#include <dartsim/Simulator.h>
+#include <stdexcept>
+
+using namespace std;
+
+namespace dart {
+namespace sim {
+
+namespace {
+
+void putInt32(string& out, int32_t value) {
+	uint32_t bits = value;
+	for (unsigned b = 0; b < 4; b++) {
+		out.push_back(char((bits >> (8 * b)) & 0xff));
+	}
+}
+
+}
+
+void EventSink::flush() {
+}
+
+EventSink::~EventSink() {
+}
+
+
+void NullEventSink::tacticExecuted(const Coordinate& /*position*/, Tactic /*tactic*/) {
+}
+
+void NullEventSink::targetDetected(const Coordinate& /*position*/) {
+}
+
+void NullEventSink::teamDestroyed(const Coordinate& /*position*/) {
+}
+
+
+const size_t StreamEventSink::DEFAULT_BUFFER_SIZE;
+
+StreamEventSink::StreamEventSink(ostream& out, size_t bufferSize)
+	: out(out), bufferSize(bufferSize)
+{
+}
+
+StreamEventSink::StreamEventSink(const string& path, size_t bufferSize)
+	: pFile(new ofstream(path, ios::binary)), out(*pFile), bufferSize(bufferSize)
+{
+	if (!pFile->is_open()) {
+		throw runtime_error("could not open " + path);
+	}
+}
+
+StreamEventSink::~StreamEventSink() {
+	flush();
+}
+
+void StreamEventSink::eventAdded() {
+	if (buffer.size() >= bufferSize) {
+		writeBuffer();
+	}
+}
+
+void StreamEventSink::writeBuffer() {
+	out.write(buffer.data(), buffer.size());
+	buffer.clear();
+}
+
+void StreamEventSink::flush() {
+	writeBuffer();
+	out.flush();
+}
+
+
+TextEventSink::TextEventSink(ostream& out, size_t bufferSize)
+	: StreamEventSink(out, bufferSize)
+{
+}
+
+TextEventSink::TextEventSink(const string& path, size_t bufferSize)
+	: StreamEventSink(path, bufferSize)
+{
+}
+
+void TextEventSink::tacticExecuted(const Coordinate& /*position*/, Tactic tactic) {
+	buffer += "executing tactic ";
+	buffer += getTacticLabel(tactic);
+	buffer += '\n';
+	eventAdded();
+}
+
+void TextEventSink::targetDetected(const Coordinate& position) {
+	buffer += "Target detected at ";
+	buffer += to_string(position.x) + ';' + to_string(position.y);
+	buffer += '\n';
+	eventAdded();
+}
+
+void TextEventSink::teamDestroyed(const Coordinate& position) {
+	buffer += "Team destroyed at position ";
+	buffer += to_string(position.x) + ';' + to_string(position.y);
+	buffer += '\n';
+	eventAdded();
+}
+
+
+const size_t BinaryEventSink::RECORD_SIZE;
+
+BinaryEventSink::BinaryEventSink(ostream& out, size_t bufferSize)
+	: StreamEventSink(out, bufferSize)
+{
+}
+
+BinaryEventSink::BinaryEventSink(const string& path, size_t bufferSize)
+	: StreamEventSink(path, bufferSize)
+{
+}
+
+void BinaryEventSink::tacticExecuted(const Coordinate& position, Tactic tactic) {
+	addRecord(TACTIC_EXECUTED, unsigned(tactic), position);
+}
+
+void BinaryEventSink::targetDetected(const Coordinate& position) {
+	addRecord(TARGET_DETECTED, 0, position);
+}
+
+void BinaryEventSink::teamDestroyed(const Coordinate& position) {
+	addRecord(TEAM_DESTROYED, 0, position);
+}
+
+void BinaryEventSink::addRecord(EventType type, unsigned tactic, const Coordinate& position) {
+	buffer.push_back(char(type));
+	buffer.push_back(char(tactic));
+	putInt32(buffer, position.x);
+	putInt32(buffer, position.y);
+	eventAdded();
+}
+
+} /* namespace sim */
+} /* namespace dart */
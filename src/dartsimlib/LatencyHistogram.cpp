@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+#include <dartsim/LatencyHistogram.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace dart {
+namespace sim {
+
+const unsigned LatencyHistogram::SUB_BUCKET_BITS;
+const unsigned LatencyHistogram::MAX_EXPONENT;
+const unsigned LatencyHistogram::NUM_BUCKETS;
+
+LatencyHistogram::LatencyHistogram() {
+	reset();
+}
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& histogram) {
+	copy(histogram);
+}
+
+LatencyHistogram& LatencyHistogram::operator=(const LatencyHistogram& histogram) {
+	if (this != &histogram) {
+		copy(histogram);
+	}
+	return *this;
+}
+
+void LatencyHistogram::copy(const LatencyHistogram& histogram) {
+
+	/* plain stores, since histograms are copied along with simulator forks and snapshots */
+	for (unsigned b = 0; b < NUM_BUCKETS; b++) {
+		buckets[b].store(histogram.buckets[b].load(memory_order_relaxed), memory_order_relaxed);
+	}
+	count.store(histogram.count.load(memory_order_relaxed), memory_order_relaxed);
+	sum.store(histogram.sum.load(memory_order_relaxed), memory_order_relaxed);
+	maxLatency.store(histogram.maxLatency.load(memory_order_relaxed), memory_order_relaxed);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& histogram) {
+	for (unsigned b = 0; b < NUM_BUCKETS; b++) {
+		buckets[b].fetch_add(histogram.buckets[b].load(memory_order_relaxed), memory_order_relaxed);
+	}
+	count.fetch_add(histogram.count.load(memory_order_relaxed), memory_order_relaxed);
+	sum.fetch_add(histogram.sum.load(memory_order_relaxed), memory_order_relaxed);
+
+	uint64_t otherMax = histogram.maxLatency.load(memory_order_relaxed);
+	uint64_t currentMax = maxLatency.load(memory_order_relaxed);
+	while (otherMax > currentMax
+			&& !maxLatency.compare_exchange_weak(currentMax, otherMax, memory_order_relaxed)) {
+	}
+}
+
+void LatencyHistogram::reset() {
+	for (auto& bucket : buckets) {
+		bucket.store(0, memory_order_relaxed);
+	}
+	count.store(0, memory_order_relaxed);
+	sum.store(0, memory_order_relaxed);
+	maxLatency.store(0, memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getCount() const {
+	return count.load(memory_order_relaxed);
+}
+
+double LatencyHistogram::getMean() const {
+	uint64_t n = getCount();
+	return (n > 0) ? double(sum.load(memory_order_relaxed)) / n : 0.0;
+}
+
+uint64_t LatencyHistogram::getMax() const {
+	return maxLatency.load(memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getQuantile(double quantile) const {
+
+	/* the bucket counts are loaded first, so that they add up to total */
+	uint64_t counts[NUM_BUCKETS];
+	uint64_t total = 0;
+	for (unsigned b = 0; b < NUM_BUCKETS; b++) {
+		counts[b] = buckets[b].load(memory_order_relaxed);
+		total += counts[b];
+	}
+	if (total == 0) {
+		return 0;
+	}
+
+	quantile = min(1.0, max(0.0, quantile));
+	uint64_t rank = max(uint64_t(1), uint64_t(ceil(quantile * total)));
+	uint64_t seen = 0;
+	unsigned b = 0;
+	while (b < NUM_BUCKETS - 1 && (seen += counts[b]) < rank) {
+		b++;
+	}
+	return min(getBucketLimit(b), getMax());
+}
+
+unsigned LatencyHistogram::getBucket(uint64_t nanoseconds) {
+	const uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;
+	if (nanoseconds < SUB_BUCKETS) {
+		return nanoseconds;
+	}
+	if (nanoseconds >> MAX_EXPONENT) {
+		return NUM_BUCKETS - 1;
+	}
+
+	unsigned exponent = 63 - __builtin_clzll(nanoseconds);
+	uint64_t mantissa = nanoseconds >> (exponent - SUB_BUCKET_BITS);
+	return ((exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + (mantissa - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::getBucketLimit(unsigned bucket) {
+	const uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;
+	unsigned block = bucket >> SUB_BUCKET_BITS;
+	if (block == 0) {
+		return bucket;
+	}
+
+	unsigned exponent = block + SUB_BUCKET_BITS - 1;
+	uint64_t mantissa = (bucket & (SUB_BUCKETS - 1)) + SUB_BUCKETS;
+	return ((mantissa + 1) << (exponent - SUB_BUCKET_BITS)) - 1;
+}
+
+} /* namespace sim */
+} /* namespace dart */
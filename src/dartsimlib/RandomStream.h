@@ -0,0 +1,160 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Counter-based random number generator
+ *
+ * The n-th number of a stream is a hash (the SplitMix64 finalizer) of the
+ * stream key and n. Therefore, streams with different keys are independent,
+ * skipping ahead in a stream only requires advancing its counter, and new
+ * streams can be split off a stream by deriving new keys from its key.
+ *
+ * It satisfies the requirements of UniformRandomBitGenerator, so it can be
+ * used with the distributions in <random>.
+ */
+class RandomStream {
+public:
+	using result_type = uint64_t;
+
+	explicit RandomStream(uint64_t key = 0, uint64_t counter = 0)
+		: key(key), counter(counter) {};
+
+	static constexpr result_type min() {
+		return 0;
+	}
+
+	static constexpr result_type max() {
+		return std::numeric_limits<result_type>::max();
+	}
+
+	result_type operator()() {
+		return mix(key + GAMMA * ++counter);
+	}
+
+	/**
+	 * @return random number uniformly distributed in [0,1)
+	 */
+	double uniform() {
+		return (operator()() >> UNIFORM_SHIFT) * DOUBLE_UNIT;
+	}
+
+	/**
+	 * Generates a block of random numbers
+	 *
+	 * This produces the same numbers as calling operator() n times, but
+	 * since the numbers do not depend on each other, the loop can be
+	 * vectorized by the compiler.
+	 *
+	 * @param out array where the n numbers are stored
+	 * @param n number of random numbers to generate
+	 */
+	void generate(result_type* out, unsigned n) {
+		const uint64_t base = key + GAMMA * counter;
+		for (unsigned i = 0; i < n; i++) {
+			out[i] = mix(base + GAMMA * (i + 1));
+		}
+		counter += n;
+	}
+
+	/**
+	 * Converts a probability to a threshold for the random numbers
+	 *
+	 * For p in [0,1], uniform() <= p is equivalent to
+	 * (operator()() >> UNIFORM_SHIFT) <= getThreshold(p), which allows
+	 * comparing blocks of random numbers without converting them to double.
+	 *
+	 * @param p probability
+	 * @return threshold
+	 */
+	static uint64_t getThreshold(double p) {
+		if (p <= 0.0) {
+			return 0;
+		}
+		return (p >= 1.0) ? (uint64_t(1) << 53) : uint64_t(p / DOUBLE_UNIT);
+	}
+
+	static constexpr unsigned UNIFORM_SHIFT = 11;
+
+	/**
+	 * Skips ahead in the stream
+	 *
+	 * @param n number of random numbers to skip
+	 */
+	void discard(uint64_t n) {
+		counter += n;
+	}
+
+	/**
+	 * Derives an independent stream from this one
+	 *
+	 * The derived stream depends only on the key of this stream and the id,
+	 * but not on how many numbers have been drawn from this stream.
+	 *
+	 * @param streamId identifier of the derived stream
+	 * @return derived stream
+	 */
+	RandomStream split(uint64_t streamId) const {
+		return RandomStream(mix(key ^ mix(streamId + GAMMA)));
+	}
+
+	uint64_t getKey() const {
+		return key;
+	}
+
+	uint64_t getCounter() const {
+		return counter;
+	}
+
+	bool operator==(const RandomStream& b) const {
+		return key == b.key && counter == b.counter;
+	}
+
+protected:
+	static constexpr uint64_t GAMMA = 0x9e3779b97f4a7c15ULL;
+	static constexpr double DOUBLE_UNIT = 1.0 / 9007199254740992.0; // 2^-53
+
+	uint64_t key;
+	uint64_t counter;
+
+	static uint64_t mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+};
+
+} /* namespace sim */
+} /* namespace dart */
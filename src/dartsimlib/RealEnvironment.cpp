@@ -27,28 +27,104 @@
  ******************************************************************************/
 
 #include "RealEnvironment.h"
-#include "RandomSeed.h"
+#include <stdexcept>
+#include <random>
 
 namespace dart {
 namespace sim {
 
-void RealEnvironment::populate(Coordinate size, unsigned numOfObjects) {
+const unsigned RealEnvironment::BITS_PER_BLOCK;
+
+namespace {
+
+/*
+ * Draws an integer in [0, bound) with a multiplication instead of the
+ * divisions of std::uniform_int_distribution. The bias is below
+ * bound / 2^64, which is negligible for the number of cells of a map.
+ */
+uint64_t drawBelow(RandomStream& randomStream, uint64_t bound) {
+	return uint64_t((static_cast<unsigned __int128>(randomStream()) * bound) >> 64);
+}
+
+}
+
+RealEnvironment::RealEnvironment(Storage storage)
+	: storage(storage)
+{
+}
+
+void RealEnvironment::populate(Coordinate size, unsigned numOfObjects, RandomStream randomStream) {
 	this->size = size;
 	envMap.clear();
+	bits.clear();
+	if (storage == Storage::MAPPED) {
+		storage = Storage::DENSE;
+		mappedBits.reset();
+	}
+	if (storage == Storage::DENSE) {
+		size_t cells = size_t(size.x) * size.y;
+		bits.resize((cells + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK, 0);
+	}
+
+	const uint64_t cells = uint64_t(size.x) * size.y;
+	if (numOfObjects > cells) {
+		throw std::invalid_argument("more objects than cells in the environment");
+	}
+
+	if (numOfObjects <= cells / 2) {
 
-	std::default_random_engine gen(RandomSeed::getNextSeed());
-	std::uniform_int_distribution<> unifX(0, size.x - 1);
-	std::uniform_int_distribution<> unifY(0, size.y - 1);
+		/*
+		 * Rejection sampling takes fewer than two draws per object on
+		 * average when at most half of the cells are taken. It is kept
+		 * for these environments so that they remain the same for a seed.
+		 */
+		std::uniform_int_distribution<> unifX(0, size.x - 1);
+		std::uniform_int_distribution<> unifY(0, size.y - 1);
 
-	while (numOfObjects > 0) {
-		unsigned x = unifX(gen);
-		unsigned y = unifY(gen);
-		while (envMap[Coordinate(x,y)]) {
-			x = unifX(gen);
-			y = unifY(gen);
+		while (numOfObjects > 0) {
+			unsigned x = unifX(randomStream);
+			unsigned y = unifY(randomStream);
+			while (isObjectAt(Coordinate(x,y))) {
+				x = unifX(randomStream);
+				y = unifY(randomStream);
+			}
+			setAt(Coordinate(x,y), true);
+			numOfObjects--;
 		}
-		envMap[Coordinate(x,y)] = true;
-		numOfObjects--;
+	} else {
+
+		/*
+		 * Floyd's algorithm draws exactly one cell index per object, so
+		 * it does not slow down as the environment fills up
+		 */
+		for (uint64_t j = cells - numOfObjects; j < cells; j++) {
+			uint64_t index = drawBelow(randomStream, j + 1);
+			Coordinate location(index % size.x, index / size.x);
+			if (isObjectAt(location)) {
+				location = Coordinate(j % size.x, j / size.x);
+			}
+			setAt(location, true);
+		}
+	}
+}
+
+void RealEnvironment::map(Coordinate size, std::shared_ptr<const BitBlock> blocks) {
+	this->size = size;
+	storage = Storage::MAPPED;
+	mappedBits = blocks;
+	envMap.clear();
+	bits.clear();
+	bits.shrink_to_fit();
+}
+
+const RealEnvironment::BitBlock* RealEnvironment::getBlocks() const {
+	switch (storage) {
+	case Storage::DENSE:
+		return bits.data();
+	case Storage::MAPPED:
+		return mappedBits.get();
+	default:
+		return nullptr;
 	}
 }
 
@@ -56,18 +132,55 @@ Coordinate RealEnvironment::getSize() const {
 	return size;
 }
 
+RealEnvironment::Storage RealEnvironment::getStorage() const {
+	return storage;
+}
+
 bool RealEnvironment::isObjectAt(Coordinate location) const {
 	bool isThere = false;
-	const auto it = envMap.find(location);
-	if (it != envMap.end()) {
-		isThere = it->second;
+	if (storage != Storage::SPARSE) {
+		if (isInside(location)) {
+			const BitBlock* blocks = (storage == Storage::DENSE) ? bits.data() : mappedBits.get();
+			size_t index = cellIndex(location);
+			isThere = (blocks[index / BITS_PER_BLOCK] >> (index % BITS_PER_BLOCK)) & 1;
+		}
+	} else {
+		const auto it = envMap.find(location);
+		if (it != envMap.end()) {
+			isThere = it->second;
+		}
 	}
 
 	return isThere;
 }
 
+bool RealEnvironment::isObjectAtCell(size_t cell) const {
+	if (storage == Storage::SPARSE) {
+		return isObjectAt(Coordinate(cell % size.x, cell / size.x));
+	}
+
+	const BitBlock* blocks = (storage == Storage::DENSE) ? bits.data() : mappedBits.get();
+	return (blocks[cell / BITS_PER_BLOCK] >> (cell % BITS_PER_BLOCK)) & 1;
+}
+
 void RealEnvironment::setAt(Coordinate location, bool objectPresent) {
-	envMap[location] = objectPresent;
+	if (storage == Storage::MAPPED) {
+		throw std::logic_error("mapped environments cannot be modified");
+	}
+	if (storage == Storage::DENSE) {
+		if (!isInside(location)) {
+			throw std::out_of_range("location outside of the environment");
+		}
+		size_t index = cellIndex(location);
+		BitBlock mask = BitBlock(1) << (index % BITS_PER_BLOCK);
+		if (objectPresent) {
+			bits[index / BITS_PER_BLOCK] |= mask;
+		} else {
+			bits[index / BITS_PER_BLOCK] &= ~mask;
+		}
+	} else {
+		envMap[location] = objectPresent;
+	}
 }
 
 
@@ -29,7 +29,11 @@
 #pragma once
 
 #include <dartsim/Route.h>
+#include "RandomStream.h"
 #include <map>
+#include <memory>
+#include <vector>
+#include <cstdint>
 
 namespace dart {
 namespace sim {
@@ -37,19 +41,92 @@ namespace sim {
 class RealEnvironment {
 public:
 
+	/**
+	 * Storage used to keep track of the objects in the environment
+	 *
+	 * DENSE keeps one bit per cell in a packed row-major bitset, so lookups
+	 * take constant time and a 10000x10000 map takes about 12 MB.
+	 * SPARSE keeps only the cells that have been set in a map, which may
+	 * be preferable for huge maps with very few objects.
+	 * MAPPED uses the layout of DENSE, but the bitset is read-only memory
+	 * owned by someone else, such as a memory-mapped scenario file.
+	 */
+	enum class Storage { DENSE, SPARSE, MAPPED };
+
+	using BitBlock = uint64_t;
+	static const unsigned BITS_PER_BLOCK = 64;
+
+	RealEnvironment(Storage storage = Storage::DENSE);
+
 	/**
 	 * Resizes environment and randomly positions objects in it.
+	 *
+	 * The expected cost is linear in the number of objects, even when
+	 * they fill the environment, and the positions depend only on the
+	 * random stream.
+	 *
+	 * @param size size of the environment
+	 * @param numOfObjects number of objects to position, which cannot be
+	 * 	more than the number of cells
+	 * @param randomStream random stream used to position the objects
+	 */
+	void populate(Coordinate size, unsigned numOfObjects, RandomStream randomStream);
+
+	/**
+	 * Makes the environment use an existing bitset, switching to MAPPED storage
+	 *
+	 * @param size size of the environment
+	 * @param blocks row-major bitset with the layout of DENSE storage. It
+	 * 	must hold one bit per cell of the environment, and it must not
+	 * 	change while the environment uses it.
+	 */
+	void map(Coordinate size, std::shared_ptr<const BitBlock> blocks);
+
+	/**
+	 * @return the bitset of DENSE and MAPPED storage, or nullptr with
+	 * 	SPARSE storage
 	 */
-	void populate(Coordinate size, unsigned numOfObjects);
+	const BitBlock* getBlocks() const;
 	Coordinate getSize() const;
+	Storage getStorage() const;
+
+	/**
+	 * @return true if there is an object at the location. Locations outside
+	 * 	of the environment never have objects.
+	 */
 	bool isObjectAt(Coordinate location) const;
+
+	/**
+	 * @param cell row-major index of a cell inside the environment
+	 * @return true if there is an object in the cell
+	 */
+	bool isObjectAtCell(size_t cell) const;
+
+	/**
+	 * Sets or clears the object at a location
+	 *
+	 * With DENSE storage, the location must be inside the environment
+	 * (i.e., populate() must have been called before to size it).
+	 * MAPPED storage cannot be modified.
+	 */
 	void setAt(Coordinate location, bool objectPresent);
 
 	virtual ~RealEnvironment();
 
 protected:
+	Storage storage;
 	Coordinate size;
-	std::map<Coordinate, bool> envMap;
+	std::vector<BitBlock> bits; /**< row-major bitset used with DENSE storage */
+	std::shared_ptr<const BitBlock> mappedBits; /**< bitset used with MAPPED storage */
+	std::map<Coordinate, bool> envMap; /**< map used with SPARSE storage */
+
+	bool isInside(const Coordinate& location) const {
+		return location.x >= 0 && location.y >= 0 && location.isInsideRect(size);
+	}
+
+	size_t cellIndex(const Coordinate& location) const {
+		return size_t(location.y) * size.x + location.x;
+	}
 };
 
 } /* namespace sim */
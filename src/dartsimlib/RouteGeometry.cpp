@@ -0,0 +1,125 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#include "RouteGeometry.h"
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace dart {
+namespace sim {
+
+namespace {
+
+/*
+ * Number of steps of size direction that stay below size starting at
+ * position, including the starting position
+ */
+uint64_t stepsBelow(CoordT position, CoordT direction, CoordT size) {
+	if (position >= size) {
+		return 0;
+	}
+	if (direction > 0) {
+		return uint64_t(int64_t(size) - 1 - position) / direction + 1;
+	}
+	return numeric_limits<uint64_t>::max();
+}
+
+/*
+ * Number of steps of size direction that stay in [0, size) starting at
+ * position, including the starting position
+ */
+uint64_t stepsInside(CoordT position, CoordT direction, CoordT size) {
+	if (position < 0) {
+		return 0;
+	}
+	if (direction < 0) {
+		return min(stepsBelow(position, direction, size), uint64_t(position) / -int64_t(direction) + 1);
+	}
+	return stepsBelow(position, direction, size);
+}
+
+}
+
+RouteGeometry::RouteGeometry(std::shared_ptr<const Route> route, Coordinate mapSize)
+	: route(route), mapSize(mapSize)
+{
+	const size_t points = route->size();
+	directions.reserve(points + 1);
+	forwardCells.reserve(points + 1);
+	insideCells.reserve(points + 1);
+
+	for (size_t p = 0; p <= points; p++) {
+		Coordinate position = (p < points) ? (*route)[p] : route->back();
+		Coordinate direction;
+		if (p + 1 < points) {
+			direction = Coordinate((*route)[p + 1].x - position.x, (*route)[p + 1].y - position.y);
+		} else if (p + 1 == points && p > 0) {
+
+			// the team keeps looking ahead in the last point of the route
+			direction = directions.back();
+		}
+
+		const uint64_t cells = min(stepsBelow(position.x, direction.x, mapSize.x),
+				stepsBelow(position.y, direction.y, mapSize.y));
+		const uint64_t inside = min(stepsInside(position.x, direction.x, mapSize.x),
+				stepsInside(position.y, direction.y, mapSize.y));
+
+		directions.push_back(direction);
+		forwardCells.push_back(min(cells, uint64_t(numeric_limits<uint32_t>::max())));
+		insideCells.push_back(min(inside, uint64_t(numeric_limits<uint32_t>::max())));
+	}
+}
+
+RouteGeometry::Ray RouteGeometry::getForwardRay(size_t routeIndex, unsigned maxCells) const {
+	const Coordinate& position = (routeIndex < route->size()) ? (*route)[routeIndex] : route->back();
+	const Coordinate& direction = directions[routeIndex];
+	Ray ray;
+	ray.length = min(maxCells, forwardCells[routeIndex]);
+	ray.cellsInside = min(ray.length, insideCells[routeIndex]);
+	ray.firstCell = (ray.cellsInside > 0) ? size_t(position.y) * mapSize.x + position.x : 0;
+	ray.stride = ptrdiff_t(direction.y) * mapSize.x + direction.x;
+	ray.first = position;
+	ray.direction = direction;
+	return ray;
+}
+
+void RouteGeometry::getForwardCells(size_t routeIndex, unsigned cells, Route& forwardCells) const {
+	const Coordinate& direction = directions[routeIndex];
+	Coordinate cell = (routeIndex < route->size()) ? (*route)[routeIndex] : route->back();
+	forwardCells.clear();
+	for (unsigned c = 0; c < cells; c++) {
+		forwardCells.push_back(cell);
+		cell.x += direction.x;
+		cell.y += direction.y;
+	}
+}
+
+} /* namespace sim */
+} /* namespace dart */
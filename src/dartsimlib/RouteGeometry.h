@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+
+#include <dartsim/Route.h>
+#include "RealEnvironment.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Direction of travel and forward ray at each point of a route
+ *
+ * These are computed once for a route in a map, so that neither stepping
+ * nor sensing has to look at the route again. Index route.size() of the
+ * tables corresponds to the end of the mission, when the team stays at the
+ * last point of the route without a direction.
+ */
+class RouteGeometry {
+public:
+
+	/**
+	 * Cells of the map in a straight line in the direction of travel
+	 *
+	 * The ray ends at the right or bottom edge of the map, but not at the
+	 * left or top edge, so its last cells can have negative coordinates.
+	 * These are sensed as cells without objects. The cells inside the map
+	 * come first and are identified by their row-major index, as used by
+	 * RealEnvironment::isObjectAtCell().
+	 */
+	struct Ray {
+		size_t firstCell;
+		ptrdiff_t stride;     /**< difference between the indices of consecutive cells */
+		unsigned cellsInside; /**< number of leading cells that are inside the map */
+		unsigned length;      /**< number of cells */
+		Coordinate first;     /**< position of the first cell */
+		Coordinate direction; /**< difference between the positions of consecutive cells */
+	};
+
+	/**
+	 * @param route route of the mission, which must not be empty
+	 * @param mapSize size of the map
+	 */
+	RouteGeometry(std::shared_ptr<const Route> route, Coordinate mapSize);
+
+	/**
+	 * @return direction of travel at a point of the route, which is the
+	 * 	one to the next point, or the one from the previous point at the
+	 * 	last point
+	 */
+	Coordinate getDirection(size_t routeIndex) const {
+		return directions[routeIndex];
+	}
+
+	/**
+	 * @param routeIndex point of the route from which the ray starts
+	 * @param maxCells maximum length of the ray
+	 * @return the ray from the point in the direction of travel. If there
+	 * 	is no direction, the ray repeats the cell of the point.
+	 */
+	Ray getForwardRay(size_t routeIndex, unsigned maxCells) const;
+
+	/**
+	 * @param routeIndex point of the route from which the cells start
+	 * @param cells number of cells
+	 * @param forwardCells where the coordinates of the cells from the
+	 * 	point in the direction of travel are stored, as in Route(point,
+	 * 	directionX, directionY, cells)
+	 */
+	void getForwardCells(size_t routeIndex, unsigned cells, Route& forwardCells) const;
+
+	/**
+	 * Looks up the cells of a ray in order
+	 *
+	 * @param visit called with the index of each cell in the ray and
+	 * 	whether there is an object in it
+	 */
+	template <class Visitor>
+	static void visitRay(const Ray& ray, const RealEnvironment& environment, Visitor visit) {
+		unsigned c = 0;
+		size_t cell = ray.firstCell;
+		for (; c < ray.cellsInside; c++, cell += ray.stride) {
+			visit(c, environment.isObjectAtCell(cell));
+		}
+		for (; c < ray.length; c++) {
+			visit(c, environment.isObjectAt(Coordinate(ray.first.x + CoordT(c) * ray.direction.x,
+					ray.first.y + CoordT(c) * ray.direction.y)));
+		}
+	}
+
+protected:
+	std::shared_ptr<const Route> route;
+	Coordinate mapSize;
+	std::vector<Coordinate> directions;
+	std::vector<uint32_t> forwardCells; /**< cells of the ray from each point in its direction */
+	std::vector<uint32_t> insideCells; /**< cells of that ray that are inside the map */
+};
+
+} /* namespace sim */
+} /* namespace dart */
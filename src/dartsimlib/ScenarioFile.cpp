@@ -0,0 +1,197 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#include "ScenarioFile.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace dart {
+namespace sim {
+
+namespace {
+
+static_assert(sizeof(ScenarioFile::Header) == 80, "the header layout is part of the file format");
+
+uint64_t alignedSize(uint64_t size) {
+	return (size + 7) & ~uint64_t(7);
+}
+
+uint64_t bitsetSize(const ScenarioFile::Header& header) {
+	uint64_t cells = uint64_t(header.width) * uint64_t(header.height);
+	uint64_t blocks = (cells + RealEnvironment::BITS_PER_BLOCK - 1) / RealEnvironment::BITS_PER_BLOCK;
+	return blocks * sizeof(RealEnvironment::BitBlock);
+}
+
+/*
+ * The bitset of an environment with the layout of DENSE storage, even if
+ * the environment uses another storage
+ */
+vector<RealEnvironment::BitBlock> getBitset(const RealEnvironment& environment, uint64_t bytes) {
+	vector<RealEnvironment::BitBlock> blocks(bytes / sizeof(RealEnvironment::BitBlock), 0);
+	const RealEnvironment::BitBlock* existingBlocks = environment.getBlocks();
+	if (existingBlocks) {
+		copy(existingBlocks, existingBlocks + blocks.size(), blocks.begin());
+	} else {
+		const Coordinate size = environment.getSize();
+		for (CoordT y = 0; y < size.y; y++) {
+			for (CoordT x = 0; x < size.x; x++) {
+				if (environment.isObjectAt(Coordinate(x, y))) {
+					size_t index = size_t(y) * size.x + x;
+					blocks[index / RealEnvironment::BITS_PER_BLOCK] |=
+							RealEnvironment::BitBlock(1) << (index % RealEnvironment::BITS_PER_BLOCK);
+				}
+			}
+		}
+	}
+	return blocks;
+}
+
+bool sectionFits(uint64_t offset, uint64_t sectionSize, uint64_t fileSize) {
+	return offset % 8 == 0 && offset <= fileSize && sectionSize <= fileSize - offset;
+}
+
+}
+
+const char ScenarioFile::MAGIC[8] = {'D', 'A', 'R', 'T', 'S', 'C', 'N', '\0'};
+const uint32_t ScenarioFile::FORMAT_VERSION;
+
+void ScenarioFile::write(const string& path, Header header,
+		const RealEnvironment& threatEnv, const RealEnvironment& targetEnv,
+		const Route& route) {
+	if (!(threatEnv.getSize() == targetEnv.getSize())) {
+		throw invalid_argument("the environments of a scenario must have the same size");
+	}
+
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = FORMAT_VERSION;
+	header.headerSize = sizeof(Header);
+	header.width = threatEnv.getSize().x;
+	header.height = threatEnv.getSize().y;
+	header.routeLength = route.size();
+
+	const uint64_t bitsetBytes = bitsetSize(header);
+	header.threatOffset = alignedSize(sizeof(Header));
+	header.targetOffset = header.threatOffset + bitsetBytes;
+	header.routeOffset = header.targetOffset + bitsetBytes;
+
+	auto threatBlocks = getBitset(threatEnv, bitsetBytes);
+	auto targetBlocks = getBitset(targetEnv, bitsetBytes);
+	vector<int32_t> coordinates;
+	coordinates.reserve(2 * route.size());
+	for (const auto& position : route) {
+		coordinates.push_back(position.x);
+		coordinates.push_back(position.y);
+	}
+
+	ofstream file(path, ios::binary | ios::trunc);
+	const char padding[8] = {};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	file.write(padding, header.threatOffset - sizeof(Header));
+	file.write(reinterpret_cast<const char*>(threatBlocks.data()), bitsetBytes);
+	file.write(reinterpret_cast<const char*>(targetBlocks.data()), bitsetBytes);
+	file.write(reinterpret_cast<const char*>(coordinates.data()),
+			coordinates.size() * sizeof(int32_t));
+	file.close();
+	if (!file) {
+		throw runtime_error("could not write scenario file " + path);
+	}
+}
+
+ScenarioFile::ScenarioFile(const string& path)
+	: data(nullptr), size(0)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw runtime_error("could not open scenario file " + path);
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || size_t(fileStat.st_size) < sizeof(Header)) {
+		close(fd);
+		throw runtime_error("scenario file " + path + " is truncated or corrupted");
+	}
+	size = fileStat.st_size;
+	data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // the mapping stays valid
+	if (data == MAP_FAILED) {
+		throw runtime_error("could not map scenario file " + path);
+	}
+
+	const Header& header = getHeader();
+	const char* error = nullptr;
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+		error = " is not a scenario file";
+	} else if (header.version != FORMAT_VERSION || header.headerSize != sizeof(Header)) {
+		error = " has an unsupported version";
+	} else if (header.width <= 0 || header.height <= 0
+			|| header.squareMap > 1
+			|| uint32_t(header.width) != header.mapSize
+			|| uint32_t(header.height) != (header.squareMap ? header.mapSize : 1)
+			|| header.routeLength == 0
+			|| !sectionFits(header.threatOffset, bitsetSize(header), size)
+			|| !sectionFits(header.targetOffset, bitsetSize(header), size)
+			|| header.routeLength > size
+			|| !sectionFits(header.routeOffset, header.routeLength * 2 * sizeof(int32_t), size)) {
+		error = " is truncated or corrupted";
+	}
+	if (error) {
+		munmap(data, size);
+		throw runtime_error("scenario file " + path + error);
+	}
+}
+
+const ScenarioFile::Header& ScenarioFile::getHeader() const {
+	return *reinterpret_cast<const Header*>(data);
+}
+
+const RealEnvironment::BitBlock* ScenarioFile::getThreatBlocks() const {
+	return reinterpret_cast<const RealEnvironment::BitBlock*>(at(getHeader().threatOffset));
+}
+
+const RealEnvironment::BitBlock* ScenarioFile::getTargetBlocks() const {
+	return reinterpret_cast<const RealEnvironment::BitBlock*>(at(getHeader().targetOffset));
+}
+
+const int32_t* ScenarioFile::getRoute() const {
+	return reinterpret_cast<const int32_t*>(at(getHeader().routeOffset));
+}
+
+ScenarioFile::~ScenarioFile() {
+	munmap(data, size);
+}
+
+} /* namespace sim */
+} /* namespace dart */
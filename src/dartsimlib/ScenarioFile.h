@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * DARTSim Mission Simulator
+ *
+ * Copyright 2019 Carnegie Mellon University. All Rights Reserved.
+ * NO WARRANTY. THIS CARNEGIE MELLON UNIVERSITY AND SOFTWARE ENGINEERING
+ * INSTITUTE MATERIAL IS FURNISHED ON AN "AS-IS" BASIS. CARNEGIE MELLON
+ * UNIVERSITY MAKES NO WARRANTIES OF ANY KIND, EITHER EXPRESSED OR IMPLIED, AS
+ * TO ANY MATTER INCLUDING, BUT NOT LIMITED TO, WARRANTY OF FITNESS FOR PURPOSE
+ * OR MERCHANTABILITY, EXCLUSIVITY, OR RESULTS OBTAINED FROM USE OF THE
+ * MATERIAL. CARNEGIE MELLON UNIVERSITY DOES NOT MAKE ANY WARRANTY OF ANY KIND
+ * WITH RESPECT TO FREEDOM FROM PATENT, TRADEMARK, OR COPYRIGHT INFRINGEMENT.
+ * 
+ * Released under a BSD (SEI)-style license, please see license.txt or contact
+ * permission@sei.cmu.edu for full terms.
+ * 
+ * [DISTRIBUTION STATEMENT A] This material has been approved for public release
+ * and unlimited distribution. Please see Copyright notice for non-US Government
+ * use and distribution.
+ * 
+ * Carnegie Mellon® is registered in the U.S. Patent and Trademark Office by
+ * Carnegie Mellon University.
+ * 
+ * This Software includes and/or makes use of Third-Party Software, each subject
+ * to its own license. See license.txt.
+ * 
+ * DM19-0045
+ ******************************************************************************/
+
+#pragma once
+
+#include "RealEnvironment.h"
+#include <dartsim/Route.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dart {
+namespace sim {
+
+/**
+ * Binary file with the environments and route of a mission
+ *
+ * The file is made to be memory-mapped and used as is, without parsing, so
+ * that large suites of fixed scenarios load quickly and their pages are
+ * shared by all the processes that use them. It has a Header followed by
+ * the threat and target bitsets, with the layout of the DENSE storage of
+ * RealEnvironment, and the route as pairs of int32 coordinates. All the
+ * sections start at multiples of 8 bytes, and the values are in the byte
+ * order of the host that wrote the file, which is checked with the magic
+ * string and the version when the file is opened.
+ */
+class ScenarioFile {
+public:
+	static const char MAGIC[8];
+	static const uint32_t FORMAT_VERSION = 1;
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t headerSize;    /**< size of this header, in bytes */
+		uint64_t seed;          /**< seed used to generate the scenario */
+		uint32_t mapSize;       /**< SimulationParams::mapSize */
+		uint32_t squareMap;     /**< SimulationParams::squareMap */
+		int32_t width;          /**< size of the environments, which must agree with mapSize and squareMap */
+		int32_t height;
+		uint32_t numThreats;
+		uint32_t numTargets;
+		uint64_t routeLength;   /**< number of coordinates in the route */
+		uint64_t threatOffset;  /**< offset of the threat bitset from the start of the file */
+		uint64_t targetOffset;  /**< offset of the target bitset */
+		uint64_t routeOffset;   /**< offset of the route */
+	};
+
+	/**
+	 * Writes a scenario file
+	 *
+	 * The header must have the parameters of the scenario, and the rest of
+	 * its fields are filled in by this method.
+	 *
+	 * @throws std::runtime_error if the file cannot be written
+	 */
+	static void write(const std::string& path, Header header,
+			const RealEnvironment& threatEnv, const RealEnvironment& targetEnv,
+			const Route& route);
+
+	/**
+	 * Maps a scenario file in memory
+	 *
+	 * @throws std::runtime_error if the file cannot be mapped, or if it
+	 * 	is not a valid scenario file of this version
+	 */
+	explicit ScenarioFile(const std::string& path);
+
+	const Header& getHeader() const;
+	const RealEnvironment::BitBlock* getThreatBlocks() const;
+	const RealEnvironment::BitBlock* getTargetBlocks() const;
+
+	/**
+	 * @return the route with x and y of each coordinate in consecutive values
+	 */
+	const int32_t* getRoute() const;
+
+	ScenarioFile(const ScenarioFile&) = delete;
+	ScenarioFile& operator=(const ScenarioFile&) = delete;
+
+	virtual ~ScenarioFile();
+
+protected:
+	void* data;
+	size_t size;
+
+	const char* at(uint64_t offset) const {
+		return static_cast<const char*>(data) + offset;
+	}
+};
+
+} /* namespace sim */
+} /* namespace dart */
@@ -25,37 +25,38 @@
  * 
  * DM19-0045
  ******************************************************************************/
-#include "RandomSeed.h"
-
+#include "SeedContext.h"
+#include <random>
 
 namespace dart {
 namespace sim {
 
-std::unique_ptr<RandomSeed> RandomSeed::instance;
-
-RandomSeed::RandomSeed() :
-	randomGenerator(std::random_device()())
-{ };
-
+namespace {
 
-RandomSeed& RandomSeed::getInstance() {
-	if (instance.get() == nullptr) {
-		instance.reset(new RandomSeed);
-	}
-	return *instance;
+uint64_t randomSeed() {
+	std::random_device randomDevice;
+	return (uint64_t(randomDevice()) << 32) | randomDevice();
 }
 
-int RandomSeed::getNextSeed() {
-	return getInstance().getSeed();
 }
 
-void RandomSeed::seed(int seed) {
-	getInstance().randomGenerator.seed(seed);
+SeedContext::SeedContext()
+	: SeedContext(randomSeed())
+{
 }
 
-int RandomSeed::getSeed() {
-	return uniform(randomGenerator);
+SeedContext::SeedContext(uint64_t seed)
+	: seed(seed), master(seed)
+{
 }
 
+RandomStream SeedContext::getStream(StreamId id) const {
+	return master.split(id);
 }
+
+uint64_t SeedContext::getSeed() const {
+	return seed;
 }
+
+} /* namespace sim */
+} /* namespace dart */
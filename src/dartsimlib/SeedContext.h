@@ -28,44 +28,57 @@
 
 #pragma once
 
-#include <random>
-#include <memory>
+#include "RandomStream.h"
+#include <cstdint>
 
 namespace dart {
 namespace sim {
 
 /**
- * This singleton is used to obtain seeds to initialized the different
- * random number generators.
+ * Source of the random number streams used by one simulation
  *
- * The seeds obtained with getNextSeed() are random, but that can be
- * itself seeded with seed().
+ * Each simulator owns its seed context, so simulators can be created and
+ * run concurrently. Every component that needs random numbers gets its own
+ * stream derived from the seed and the component's StreamId. Hence, the
+ * random behavior of a simulation depends only on its seed, and not on
+ * the order in which its components or other simulators are created.
  */
-class RandomSeed {
+class SeedContext {
 public:
 
 	/**
-	 * Get the next (random) seed
+	 * Identifiers of the random streams used in a simulation
 	 */
-	static int getNextSeed();
+	enum StreamId {
+		THREAT_ENVIRONMENT,
+		TARGET_ENVIRONMENT,
+		FORWARD_THREAT_SENSOR,
+		FORWARD_TARGET_SENSOR,
+		THREAT,
+		TARGET_SENSOR
+	};
 
 	/**
-	 * Seed the generator used to generate random seeds.
+	 * Creates a seed context with a random seed
 	 */
-	static void seed(int seed);
+	SeedContext();
 
-protected:
-	std::uniform_int_distribution<> uniform;
-	std::default_random_engine randomGenerator;
+	/**
+	 * Creates a seed context with the given seed
+	 */
+	explicit SeedContext(uint64_t seed);
 
-	// to make it singleton
-	RandomSeed();
+	/**
+	 * @return random stream for the given identifier
+	 */
+	RandomStream getStream(StreamId id) const;
 
-	static inline RandomSeed& getInstance();
-	int getSeed();
+	uint64_t getSeed() const;
 
-	static std::unique_ptr<RandomSeed> instance;
+protected:
+	uint64_t seed;
+	RandomStream master;
 };
 
-}
-}
+} /* namespace sim */
+} /* namespace dart */
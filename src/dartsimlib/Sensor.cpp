@@ -27,23 +27,27 @@
  ******************************************************************************/
 
 #include "Sensor.h"
-#include "RandomSeed.h"
+#include <algorithm>
+#include <bitset>
 #include <iostream>
+#include <random>
 
 using namespace std;
 
 namespace dart {
 namespace sim {
 
-Sensor::Sensor(double falsePositiveRate, double falseNegativeRate)
-	: fpr(falsePositiveRate), fnr(falseNegativeRate)
+Sensor::Sensor(double falsePositiveRate, double falseNegativeRate, RandomStream randomStream)
+	: fpr(falsePositiveRate), fnr(falseNegativeRate),
+	  fprThreshold(RandomStream::getThreshold(falsePositiveRate)),
+	  fnrThreshold(RandomStream::getThreshold(falseNegativeRate)),
+	  randomStream(randomStream)
 {
-	randomGenerator.seed(RandomSeed::getNextSeed());
 }
 
 bool Sensor::sense(bool truth) {
 	bool result = truth;
-	double random = uniform(randomGenerator);
+	double random = randomStream.uniform();
 	if (truth && random <= fnr) {
 		result = false;
 	} else if (!truth && random <= fpr) {
@@ -53,6 +57,44 @@ bool Sensor::sense(bool truth) {
 	return result;
 }
 
+unsigned Sensor::sense(bool truth, unsigned numOfObservations, uint64_t* bits) {
+	const unsigned BLOCK_SIZE = 64;
+	RandomStream::result_type block[BLOCK_SIZE];
+
+	/*
+	 * With truth, an observation is negative if random <= fnr.
+	 * Without it, an observation is positive if random <= fpr.
+	 */
+	const uint64_t threshold = (truth) ? fnrThreshold : fprThreshold;
+
+	unsigned count = 0;
+	for (unsigned first = 0; first < numOfObservations; first += BLOCK_SIZE) {
+		const unsigned size = min(BLOCK_SIZE, numOfObservations - first);
+		randomStream.generate(block, size);
+
+		uint64_t word = 0;
+		for (unsigned i = 0; i < size; i++) {
+			word |= uint64_t((block[i] >> RandomStream::UNIFORM_SHIFT) <= threshold) << i;
+		}
+		if (truth) {
+			word = ~word & (~uint64_t(0) >> (BLOCK_SIZE - size));
+		}
+
+		bits[first / BLOCK_SIZE] = word;
+		count += bitset<BLOCK_SIZE>(word).count();
+	}
+
+	return count;
+}
+
+unsigned Sensor::count(bool truth, unsigned numOfObservations) {
+	double probOfPositive = (truth) ? 1.0 - fnr : fpr;
+	probOfPositive = min(1.0, max(0.0, probOfPositive));
+
+	binomial_distribution<unsigned> binomial(numOfObservations, probOfPositive);
+	return binomial(randomStream);
+}
+
 Sensor::~Sensor() {
 }
 
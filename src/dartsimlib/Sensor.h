@@ -28,7 +28,8 @@
 
 #pragma once
 
-#include <random>
+#include "RandomStream.h"
+#include <cstdint>
 
 namespace dart {
 namespace sim {
@@ -38,15 +39,45 @@ namespace sim {
  */
 class Sensor {
 public:
-	Sensor(double falsePositiveRate, double falseNegativeRate);
+	Sensor(double falsePositiveRate, double falseNegativeRate, RandomStream randomStream);
 	bool sense(bool truth);
+
+	/**
+	 * Senses the same ground truth several times
+	 *
+	 * The result is the same as calling sense(truth) numOfObservations
+	 * times, but the random numbers are generated and compared in blocks.
+	 *
+	 * @param truth ground truth
+	 * @param numOfObservations number of observations
+	 * @param bits array of (numOfObservations + 63) / 64 words where the
+	 * 	observation i is stored in bit (i % 64) of word (i / 64)
+	 * @return number of positive observations
+	 */
+	unsigned sense(bool truth, unsigned numOfObservations, uint64_t* bits);
+
+	/**
+	 * Counts the positive observations of the same ground truth
+	 *
+	 * The count is sampled from the binomial distribution of the number of
+	 * positive observations, so its cost does not depend on the number of
+	 * observations. It does not produce the same count as sensing the
+	 * observations one by one.
+	 *
+	 * @param truth ground truth
+	 * @param numOfObservations number of observations
+	 * @return number of positive observations
+	 */
+	unsigned count(bool truth, unsigned numOfObservations);
+
 	virtual ~Sensor();
 
 protected:
 	double fpr; /**< false positive rate */
 	double fnr; /**< false negative rate */
-	std::uniform_real_distribution<> uniform;
-	std::default_random_engine randomGenerator;
+	uint64_t fprThreshold; /**< fpr as a threshold for raw random numbers */
+	uint64_t fnrThreshold; /**< fnr as a threshold for raw random numbers */
+	RandomStream randomStream;
 };
 
 } /* namespace sim */
@@ -26,25 +26,91 @@
  * DM19-0045
  ******************************************************************************/
 #include "SimulatorImpl.h"
+#include "ScenarioFile.h"
 #include <iostream>
 #include <getopt.h>
 #include <cstdlib>
+#include <cmath>
+#include <limits>
 #include <string.h>
-#include "RandomSeed.h"
+#include "SeedContext.h"
 
 using namespace std;
 
 namespace dart {
 namespace sim {
 
-const string Simulator::INC_ALTITUDE = "IncAlt";
-const string Simulator::DEC_ALTITUDE = "DecAlt";
-const string Simulator::INC_ALTITUDE2 = "IncAlt2";
-const string Simulator::DEC_ALTITUDE2 = "DecAlt2";
-const string Simulator::GO_TIGHT = "GoTight";
-const string Simulator::GO_LOOSE = "GoLoose";
-const string Simulator::ECM_ON = "EcmOn";
-const string Simulator::ECM_OFF = "EcmOff";
+const string Simulator::INC_ALTITUDE = getTacticLabel(Tactic::INC_ALTITUDE);
+const string Simulator::DEC_ALTITUDE = getTacticLabel(Tactic::DEC_ALTITUDE);
+const string Simulator::INC_ALTITUDE2 = getTacticLabel(Tactic::INC_ALTITUDE2);
+const string Simulator::DEC_ALTITUDE2 = getTacticLabel(Tactic::DEC_ALTITUDE2);
+const string Simulator::GO_TIGHT = getTacticLabel(Tactic::GO_TIGHT);
+const string Simulator::GO_LOOSE = getTacticLabel(Tactic::GO_LOOSE);
+const string Simulator::ECM_ON = getTacticLabel(Tactic::ECM_ON);
+const string Simulator::ECM_OFF = getTacticLabel(Tactic::ECM_OFF);
+
+namespace {
+
+/*
+ * Checks at compile time that each tactic can be found by its label
+ */
+constexpr bool tacticLabelsAreUnique() {
+	for (unsigned t = 0; t < TacticSet::NUM_TACTICS; t++) {
+		if (parseTactic(getTacticLabel(Tactic(t))) != Tactic(t)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static_assert(tacticLabelsAreUnique(), "tactic labels must be unique");
+
+/*
+ * @return true if the density is in [0, 1], which excludes NaN
+ */
+bool isValidDensity(double density) {
+	return density >= 0 && density <= 1;
+}
+
+/*
+ * Sets count to the number of objects for a density, unless the density is 0
+ *
+ * @return false if the count does not fit in an unsigned
+ */
+bool densityToCount(double density, double cells, unsigned& count) {
+	if (density > 0) {
+		const double objects = round(density * cells);
+		if (objects > numeric_limits<unsigned>::max()) {
+			return false;
+		}
+		count = unsigned(objects);
+	}
+	return true;
+}
+
+}
+
+const string& getTacticName(Tactic tactic) {
+	switch (tactic) {
+	case Tactic::INC_ALTITUDE:
+		return Simulator::INC_ALTITUDE;
+	case Tactic::DEC_ALTITUDE:
+		return Simulator::DEC_ALTITUDE;
+	case Tactic::INC_ALTITUDE2:
+		return Simulator::INC_ALTITUDE2;
+	case Tactic::DEC_ALTITUDE2:
+		return Simulator::DEC_ALTITUDE2;
+	case Tactic::GO_TIGHT:
+		return Simulator::GO_TIGHT;
+	case Tactic::GO_LOOSE:
+		return Simulator::GO_LOOSE;
+	case Tactic::ECM_ON:
+		return Simulator::ECM_ON;
+	case Tactic::ECM_OFF:
+		return Simulator::ECM_OFF;
+	}
+	throw std::invalid_argument("unknown tactic");
+}
 
 enum ARGS {
 	MAP_SIZE,
@@ -61,7 +127,15 @@ enum ARGS {
 	AUTO_RANGE,
 	CHANGE_ALT_LATENCY_PERIODS,
 	SEED,
-	OPT_TEST
+	OPT_TEST,
+	SPARSE_ENV,
+	EVENT_LOG,
+	EVENT_LOG_FILE,
+	NO_TRAJECTORY,
+	METRICS,
+	SCENARIO,
+	THREAT_DENSITY,
+	TARGET_DENSITY
 };
 
 static struct option long_options[] = {
@@ -69,6 +143,8 @@ static struct option long_options[] = {
 	{"square-map", no_argument, 0,  SQUARE_MAP },
 	{"num-targets", required_argument, 0,  NUM_TARGETS },
 	{"num-threats", required_argument, 0,  NUM_THREATS },
+	{"target-density", required_argument, 0,  TARGET_DENSITY },
+	{"threat-density", required_argument, 0,  THREAT_DENSITY },
 	{"altitude-levels", required_argument, 0,  ALTITUDE_LEVELS },
 	{"threat-range", required_argument, 0,  THREAT_RANGE },
     {"threat-sensor-fpr", required_argument, 0,  THREAT_SENSOR_FPR },
@@ -80,6 +156,12 @@ static struct option long_options[] = {
 	{"change-alt-latency", required_argument, 0, CHANGE_ALT_LATENCY_PERIODS },
 	{"seed", required_argument, 0, SEED },
 	{"opt-test", no_argument, 0, OPT_TEST },
+	{"sparse-env", no_argument, 0, SPARSE_ENV },
+	{"event-log", required_argument, 0, EVENT_LOG },
+	{"event-log-file", required_argument, 0, EVENT_LOG_FILE },
+	{"no-trajectory", no_argument, 0, NO_TRAJECTORY },
+	{"metrics", no_argument, 0, METRICS },
+	{"scenario", required_argument, 0, SCENARIO },
     {0, 0, 0, 0 }
 };
 
@@ -98,9 +180,21 @@ void Simulator::usage() {
 
 Simulator* Simulator::createInstance(int argc, char** argv) {
 	dart::sim::SimulationParams simParams;
+	dart::sim::ScenarioParams scenarioParams;
+
+	if (!parseArguments(argc, argv, simParams, scenarioParams)) {
+		return nullptr;
+	}
+
+	return createInstance(simParams, scenarioParams);
+}
+
+bool Simulator::parseArguments(int argc, char** argv,
+		SimulationParams& simParams, ScenarioParams& scenarioParams) {
 	bool autoRange = false;
-	unsigned numThreats = 6;
-	unsigned numTargets = 4;
+	string eventLog;
+	string eventLogFile;
+	optind = 1; // reset getopt scanning
 
 	// split options
 	int simArgc = 0;
@@ -130,10 +224,24 @@ Simulator* Simulator::createInstance(int argc, char** argv) {
 			simParams.squareMap = true;
 			break;
 		case NUM_TARGETS:
-			numTargets = atoi(optarg);
+			scenarioParams.numTargets = atoi(optarg);
 			break;
 		case NUM_THREATS:
-			numThreats = atoi(optarg);
+			scenarioParams.numThreats = atoi(optarg);
+			break;
+		case TARGET_DENSITY:
+			scenarioParams.targetDensity = atof(optarg);
+			if (!isValidDensity(scenarioParams.targetDensity)) {
+				cout << "error: densities must be between 0 and 1" << endl;
+				return false;
+			}
+			break;
+		case THREAT_DENSITY:
+			scenarioParams.threatDensity = atof(optarg);
+			if (!isValidDensity(scenarioParams.threatDensity)) {
+				cout << "error: densities must be between 0 and 1" << endl;
+				return false;
+			}
 			break;
 		case ALTITUDE_LEVELS:
 			simParams.altitudeLevels = atoi(optarg);
@@ -163,18 +271,37 @@ Simulator* Simulator::createInstance(int argc, char** argv) {
 			simParams.changeAltitudeLatencyPeriods = atoi(optarg);
 			break;
 		case SEED:
-			dart::sim::RandomSeed::seed(atoi(optarg));
+			scenarioParams.seeded = true;
+			scenarioParams.seed = atoi(optarg);
 			break;
 		case OPT_TEST:
 			simParams.optimalityTest = true;
 			break;
+		case SPARSE_ENV:
+			scenarioParams.sparseEnvironment = true;
+			break;
+		case EVENT_LOG:
+			eventLog = optarg;
+			break;
+		case EVENT_LOG_FILE:
+			eventLogFile = optarg;
+			break;
+		case NO_TRAJECTORY:
+			simParams.recordTrajectory = false;
+			break;
+		case METRICS:
+			simParams.collectMetrics = true;
+			break;
+		case SCENARIO:
+			scenarioParams.scenarioFile = optarg;
+			break;
 		default:
-			return nullptr;
+			return false;
 		}
 	}
 
 	if (optind < simArgc) {
-		return nullptr;
+		return false;
 	}
 
 	if (autoRange) {
@@ -182,24 +309,77 @@ Simulator* Simulator::createInstance(int argc, char** argv) {
 		simParams.threat.threatRange = simParams.altitudeLevels * 3 / 4;
 	}
 
-	if (numTargets > simParams.mapSize) {
-		cout << "error: number of targets cannot be larger than map size" << endl;
-		return nullptr;
+	if (eventLog.empty() && !eventLogFile.empty()) {
+		eventLog = "text";
 	}
 
-	if (numThreats > simParams.mapSize) {
-		cout << "error: number of threats cannot be larger than map size" << endl;
-		return nullptr;
+	try {
+		if (eventLog == "none") {
+			simParams.eventSink = make_shared<NullEventSink>();
+		} else if (eventLog == "text") {
+			simParams.eventSink = (eventLogFile.empty())
+					? make_shared<TextEventSink>(cout, 0) // keep order with other output
+					: make_shared<TextEventSink>(eventLogFile);
+		} else if (eventLog == "binary") {
+			if (eventLogFile.empty()) {
+				cout << "error: binary event log requires --event-log-file" << endl;
+				return false;
+			}
+			simParams.eventSink = make_shared<BinaryEventSink>(eventLogFile);
+		} else if (!eventLog.empty()) {
+			return false;
+		}
+	} catch (std::runtime_error& e) {
+		cout << "error: " << e.what() << endl;
+		return false;
+	}
+
+	return true;
+}
+
+namespace {
+
+/*
+ * Generates the environments and the route of a mission
+ *
+ * The numbers of threats and targets in scenarioParams are set to those in
+ * the environments if they are given as densities.
+ *
+ * @return false if the parameters are invalid
+ */
+bool generateScenario(const SimulationParams& simParams, ScenarioParams& scenarioParams,
+		const SeedContext& seedContext, RealEnvironment& threatEnv, RealEnvironment& targetEnv,
+		Route& route) {
+	const double cells = (simParams.squareMap) ? double(simParams.mapSize) * simParams.mapSize
+			: simParams.mapSize;
+
+	if (!isValidDensity(scenarioParams.threatDensity) || !isValidDensity(scenarioParams.targetDensity)) {
+		cout << "error: densities must be between 0 and 1" << endl;
+		return false;
+	}
+	if (!densityToCount(scenarioParams.threatDensity, cells, scenarioParams.numThreats)
+			|| !densityToCount(scenarioParams.targetDensity, cells, scenarioParams.numTargets)) {
+		cout << "error: too many objects for the given densities" << endl;
+		return false;
+	}
+	unsigned numThreats = scenarioParams.numThreats;
+	unsigned numTargets = scenarioParams.numTargets;
+
+	if (numTargets > cells) {
+		cout << "error: number of targets cannot be larger than the number of cells" << endl;
+		return false;
+	}
+
+	if (numThreats > cells) {
+		cout << "error: number of threats cannot be larger than the number of cells" << endl;
+		return false;
 	}
 
 
 	// generate environment
 #if FIXED2DSPACE
-	RealEnvironment threatEnv;
-	threatEnv.populate(Coordinate(10, 10), 0);
-
-	RealEnvironment targetEnv;
-	targetEnv.populate(Coordinate(10, 10), 0);
+	threatEnv.populate(Coordinate(10, 10), 0, seedContext.getStream(SeedContext::THREAT_ENVIRONMENT));
+	targetEnv.populate(Coordinate(10, 10), 0, seedContext.getStream(SeedContext::TARGET_ENVIRONMENT));
 
 	threatEnv.setAt(Coordinate(2,2), true);
 	threatEnv.setAt(Coordinate(3,2), true);
@@ -210,26 +390,25 @@ Simulator* Simulator::createInstance(int argc, char** argv) {
 	targetEnv.setAt(Coordinate(7,2), true);
 	targetEnv.setAt(Coordinate(7,5), true);
 #else
-	dart::sim::RealEnvironment threatEnv;
-	dart::sim::RealEnvironment targetEnv;
-
 	if (simParams.squareMap) {
 
 		/* generate true environment */
-		threatEnv.populate(dart::sim::Coordinate(simParams.mapSize, simParams.mapSize), numThreats);
-		targetEnv.populate(dart::sim::Coordinate(simParams.mapSize, simParams.mapSize), numTargets);
+		threatEnv.populate(dart::sim::Coordinate(simParams.mapSize, simParams.mapSize), numThreats,
+				seedContext.getStream(SeedContext::THREAT_ENVIRONMENT));
+		targetEnv.populate(dart::sim::Coordinate(simParams.mapSize, simParams.mapSize), numTargets,
+				seedContext.getStream(SeedContext::TARGET_ENVIRONMENT));
 	} else {
 
 		/* generate true environment */
-		threatEnv.populate(dart::sim::Coordinate(simParams.mapSize, 1), numThreats);
-		targetEnv.populate(dart::sim::Coordinate(simParams.mapSize, 1), numTargets);
+		threatEnv.populate(dart::sim::Coordinate(simParams.mapSize, 1), numThreats,
+				seedContext.getStream(SeedContext::THREAT_ENVIRONMENT));
+		targetEnv.populate(dart::sim::Coordinate(simParams.mapSize, 1), numTargets,
+				seedContext.getStream(SeedContext::TARGET_ENVIRONMENT));
 	}
 #endif
 
 
 	// generate route
-	dart::sim::Route route;
-
 #if FIXED2DSPACE
 	unsigned x = 2;
 	unsigned y = 2;
@@ -259,6 +438,73 @@ Simulator* Simulator::createInstance(int argc, char** argv) {
 	}
 #endif
 
+	return true;
+}
+
+/*
+ * Loads the environments and the route of a mission from a scenario file
+ *
+ * The environments use the bitsets in the mapped file, which stays mapped
+ * while they refer to it. The parameters of the scenario in simParams and
+ * scenarioParams are replaced with those in the file.
+ *
+ * @return the seed with which the scenario was generated
+ * @throws std::runtime_error if the file cannot be loaded
+ */
+uint64_t loadScenario(const string& path, SimulationParams& simParams, ScenarioParams& scenarioParams,
+		RealEnvironment& threatEnv, RealEnvironment& targetEnv, Route& route) {
+	auto pFile = make_shared<const ScenarioFile>(path);
+	const auto& header = pFile->getHeader();
+	simParams.mapSize = header.mapSize;
+	simParams.squareMap = header.squareMap;
+	scenarioParams.numThreats = header.numThreats;
+	scenarioParams.numTargets = header.numTargets;
+
+	const Coordinate size(header.width, header.height);
+	threatEnv.map(size, shared_ptr<const RealEnvironment::BitBlock>(pFile, pFile->getThreatBlocks()));
+	targetEnv.map(size, shared_ptr<const RealEnvironment::BitBlock>(pFile, pFile->getTargetBlocks()));
+
+	const int32_t* coordinates = pFile->getRoute();
+	route.reserve(header.routeLength);
+	for (uint64_t c = 0; c < header.routeLength; c++) {
+		route.push_back(Coordinate(coordinates[2 * c], coordinates[2 * c + 1]));
+	}
+
+	return header.seed;
+}
+
+}
+
+Simulator* Simulator::createInstance(const SimulationParams& params,
+		const ScenarioParams& scenario) {
+	dart::sim::SimulationParams simParams = params;
+	dart::sim::ScenarioParams scenarioParams = scenario;
+	auto envStorage = (scenarioParams.sparseEnvironment)
+			? RealEnvironment::Storage::SPARSE : RealEnvironment::Storage::DENSE;
+	dart::sim::RealEnvironment threatEnv(envStorage);
+	dart::sim::RealEnvironment targetEnv(envStorage);
+	auto route = make_shared<dart::sim::Route>(); // shared with the simulator to avoid copying it
+	SeedContext seedContext(0);
+
+	if (!scenarioParams.scenarioFile.empty()) {
+		uint64_t scenarioSeed;
+		try {
+			scenarioSeed = loadScenario(scenarioParams.scenarioFile, simParams, scenarioParams,
+					threatEnv, targetEnv, *route);
+		} catch (std::runtime_error& e) {
+			cout << "error: " << e.what() << endl;
+			return nullptr;
+		}
+
+		// the seed of the scenario is used for the rest of the simulation unless another one was given
+		seedContext = (scenarioParams.seeded) ? SeedContext(scenarioParams.seed) : SeedContext(scenarioSeed);
+	} else {
+		seedContext = (scenarioParams.seeded) ? SeedContext(scenarioParams.seed) : SeedContext();
+		if (!generateScenario(simParams, scenarioParams, seedContext, threatEnv, targetEnv, *route)) {
+			return nullptr;
+		}
+	}
+
 	// change parameters if doing optimality test
 	if (simParams.optimalityTest) {
 		simParams.longRangeSensor.targetSensorFNR = 0;
@@ -274,22 +520,39 @@ Simulator* Simulator::createInstance(int argc, char** argv) {
 	}
 
 
-	// instantiate adaptation manager
-	// replace seeds that would have been consumed by the sensor and threat used in the old utility fc
-	dart::sim::RandomSeed::getNextSeed();
-	dart::sim::RandomSeed::getNextSeed();
-	dart::sim::RandomSeed::getNextSeed();
-	dart::sim::RandomSeed::getNextSeed();
-
-	unsigned missionSuccessTargetThreshold = numTargets / 2.0;
-	return new SimulatorImpl(simParams, threatEnv, targetEnv,
+	unsigned missionSuccessTargetThreshold = scenarioParams.numTargets / 2.0;
+	return new SimulatorImpl(simParams, seedContext, threatEnv, targetEnv,
 			route, missionSuccessTargetThreshold);
 }
 
+void Simulator::writeScenario(const std::string& path, const SimulationParams& simParams,
+		const ScenarioParams& scenario) {
+	ScenarioParams scenarioParams = scenario;
+	SeedContext seedContext = (scenarioParams.seeded)
+			? SeedContext(scenarioParams.seed) : SeedContext();
+	RealEnvironment threatEnv;
+	RealEnvironment targetEnv;
+	Route route;
+	if (!generateScenario(simParams, scenarioParams, seedContext, threatEnv, targetEnv, route)) {
+		throw std::invalid_argument("invalid scenario parameters");
+	}
+
+	ScenarioFile::Header header = {};
+	header.seed = seedContext.getSeed();
+	header.mapSize = simParams.mapSize;
+	header.squareMap = simParams.squareMap;
+	header.numThreats = scenarioParams.numThreats;
+	header.numTargets = scenarioParams.numTargets;
+	ScenarioFile::write(path, header, threatEnv, targetEnv, route);
+}
+
 
 Simulator::~Simulator() {
 }
 
+SimulatorSnapshot::~SimulatorSnapshot() {
+}
+
 } /* namespace sim */
 } /* namespace dart */
 
@@ -29,94 +29,220 @@
 #include "DeterministicThreat.h"
 #include "DeterministicTargetSensor.h"
 #include <math.h>
-#include <sstream>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 using namespace std;
 
 namespace dart {
 namespace sim {
 
-SimulatorImpl::SimulatorImpl(const SimulationParams& simParams,
+namespace {
+
+/*
+ * Order in which the tactics of a step are executed, which is the
+ * alphabetical order of their labels in which a TacticList is iterated.
+ * It matters for tactics that cancel each other, such as GoTight and
+ * GoLoose.
+ */
+const Tactic EXECUTION_ORDER[] = {
+	Tactic::DEC_ALTITUDE,
+	Tactic::DEC_ALTITUDE2,
+	Tactic::ECM_OFF,
+	Tactic::ECM_ON,
+	Tactic::GO_LOOSE,
+	Tactic::GO_TIGHT,
+	Tactic::INC_ALTITUDE,
+	Tactic::INC_ALTITUDE2
+};
+
+/*
+ * Decision times are reported in milliseconds, and their histogram is in nanoseconds
+ */
+const double NSEC_PER_MSEC = 1e6;
+
+}
+
+SimulatorImpl::SimulatorImpl(const SimulationParams& simParams, const SeedContext& seedContext,
 		const RealEnvironment& threatEnv, const RealEnvironment& targetEnv,
-		const Route& route, unsigned missionSuccessTargetThreshold)
-	: params(simParams),
-	  threatEnv(threatEnv), targetEnv(targetEnv), route(route),
-	  screen(route.size(), vector<char>(simParams.altitudeLevels + 2, ' ')),
+		std::shared_ptr<const Route> route, unsigned missionSuccessTargetThreshold)
+	: params(simParams), seedContext(seedContext),
+	  threatEnv(make_shared<const RealEnvironment>(threatEnv)),
+	  targetEnv(make_shared<const RealEnvironment>(targetEnv)),
+	  route(route),
+	  routeGeometry(make_shared<const RouteGeometry>(route, threatEnv.getSize())),
+	  eventSink(simParams.eventSink),
 	  currentConfig({simParams.altitudeLevels, TeamConfiguration::Formation::LOOSE, false, 0, 0, 0, 0}),
-	  routeIt(this->route.begin()),
+	  routeIt(this->route->begin()),
 	  changeAltitudeLatencyPeriods(simParams.changeAltitudeLatencyPeriods),
 	  position(*routeIt),
 	  MISSION_SUCCESS_THRESHOLD(missionSuccessTargetThreshold),
 	  SCREEN_THREATS(simParams.altitudeLevels),
 	  SCREEN_TARGETS(simParams.altitudeLevels + 1)
 {
+	if (!eventSink) {
+		eventSink = make_shared<NullEventSink>();
+	}
 
 	/* create simulators of target sensors and threats */
-	pTargetSensor = createTargetSensor(simParams);
-	pThreatSim = createThreatSim(simParams);
+	pTargetSensor = createTargetSensor(simParams, seedContext);
+	pThreatSim = createThreatSim(simParams, seedContext);
 
 	/* create forward-looking sensors */
 	pFwdThreatSensor = make_unique<Sensor>(simParams.longRangeSensor.threatSensorFPR,
-			simParams.longRangeSensor.threatSensorFNR);
+			simParams.longRangeSensor.threatSensorFNR,
+			seedContext.getStream(SeedContext::FORWARD_THREAT_SENSOR));
 	pFwdTargetSensor = make_unique<Sensor>(simParams.longRangeSensor.targetSensorFPR,
-			simParams.longRangeSensor.targetSensorFNR);
+			simParams.longRangeSensor.targetSensorFNR,
+			seedContext.getStream(SeedContext::FORWARD_TARGET_SENSOR));
 
 	updateDirection();
 
-	/* initialize screen */
-	for (unsigned p = 0; p < route.size(); p++) {
-		for (unsigned h = 0; h < simParams.altitudeLevels; h++) {
-			screen[p][h] = ' ';
-		}
-		if (threatEnv.isObjectAt(route.at(p))) {
-			screen[p][SCREEN_THREATS] = '^';
-		} else {
-			screen[p][SCREEN_THREATS] = ' ';
-		}
-		if (targetEnv.isObjectAt(route.at(p))) {
-			screen[p][SCREEN_TARGETS] = 'T';
-		} else {
-			screen[p][SCREEN_TARGETS] = ' ';
-		}
+	if (simParams.recordTrajectory) {
+		trajectory = make_shared<SharedTrajectory>();
+		trajectory->points.reserve(route->size());
 	}
+	decisionTimeHistogram = make_shared<LatencyHistogram>();
 
+	if (simParams.collectMetrics) {
+		pMetrics = make_unique<SimulatorMetrics>();
+	}
 }
 
+SimulatorImpl::SimulatorImpl(const SimulatorImpl& simulator)
+	: params(simulator.params), seedContext(simulator.seedContext),
+	  threatEnv(simulator.threatEnv), targetEnv(simulator.targetEnv),
+	  route(simulator.route),
+	  routeGeometry(simulator.routeGeometry),
+	  pFwdThreatSensor(make_unique<Sensor>(*simulator.pFwdThreatSensor)),
+	  pFwdTargetSensor(make_unique<Sensor>(*simulator.pFwdTargetSensor)),
+	  pTargetSensor(simulator.pTargetSensor->clone()),
+	  pThreatSim(simulator.pThreatSim->clone()),
+	  eventSink(make_shared<NullEventSink>()), // the events of forks are not reported
+	  decisionTimeHistogram(make_shared<LatencyHistogram>()),
+	  currentConfig(simulator.currentConfig),
+	  targetsDetected(simulator.targetsDetected),
+	  destroyed(simulator.destroyed),
+	  routeIt(simulator.routeIt),
+	  changeAltitudeLatencyPeriods(simulator.changeAltitudeLatencyPeriods),
+	  position(simulator.position),
+	  MISSION_SUCCESS_THRESHOLD(simulator.MISSION_SUCCESS_THRESHOLD),
+	  SCREEN_THREATS(simulator.SCREEN_THREATS),
+	  SCREEN_TARGETS(simulator.SCREEN_TARGETS),
+	  directionX(simulator.directionX),
+	  directionY(simulator.directionY)
+{
+	/*
+	 * forks are used for rollouts, so, like their events, their trajectory
+	 * is not recorded, and they only measure their own decision times
+	 */
+	params.eventSink.reset();
+	params.recordTrajectory = false;
+
+	if (params.collectMetrics) {
+		pMetrics = make_unique<SimulatorMetrics>();
+	}
+}
+
+SimulatorImpl::Snapshot::Snapshot(const SimulatorImpl& simulator)
+	: route(simulator.route),
+	  fwdThreatSensor(*simulator.pFwdThreatSensor),
+	  fwdTargetSensor(*simulator.pFwdTargetSensor),
+	  pTargetSensor(simulator.pTargetSensor->clone()),
+	  pThreatSim(simulator.pThreatSim->clone()),
+	  trajectory(simulator.trajectory),
+	  trajectoryLength(simulator.trajectoryLength),
+	  decisionTimeStats(simulator.decisionTimeStats),
+	  decisionTimeHistogram(simulator.decisionTimeHistogram),
+	  currentConfig(simulator.currentConfig),
+	  targetsDetected(simulator.targetsDetected),
+	  destroyed(simulator.destroyed),
+	  routeIndex(simulator.routeIt - simulator.route->begin()),
+	  position(simulator.position),
+	  directionX(simulator.directionX),
+	  directionY(simulator.directionY)
+{
+	if (trajectory) {
+		trajectory->sharedLength = std::max(trajectory->sharedLength, trajectoryLength);
+	}
+}
+
+shared_ptr<const SimulatorSnapshot> SimulatorImpl::snapshot() const {
+	return make_shared<Snapshot>(*this);
+}
+
+void SimulatorImpl::restore(const SimulatorSnapshot& simulatorSnapshot) {
+	auto pSnapshot = dynamic_cast<const Snapshot*>(&simulatorSnapshot);
+	if (pSnapshot == nullptr || pSnapshot->route != route) {
+		throw std::invalid_argument("snapshot of a different mission");
+	}
+
+	*pFwdThreatSensor = pSnapshot->fwdThreatSensor;
+	*pFwdTargetSensor = pSnapshot->fwdTargetSensor;
+	pTargetSensor = pSnapshot->pTargetSensor->clone();
+	pThreatSim = pSnapshot->pThreatSim->clone();
+	if (params.recordTrajectory) {
+		trajectory = pSnapshot->trajectory;
+		trajectoryLength = pSnapshot->trajectoryLength;
+	}
+	decisionTimeStats = pSnapshot->decisionTimeStats;
+	decisionTimeHistogram = pSnapshot->decisionTimeHistogram;
+	currentConfig = pSnapshot->currentConfig;
+	targetsDetected = pSnapshot->targetsDetected;
+	destroyed = pSnapshot->destroyed;
+	routeIt = route->begin() + pSnapshot->routeIndex;
+	position = pSnapshot->position;
+	directionX = pSnapshot->directionX;
+	directionY = pSnapshot->directionY;
+}
+
+Simulator* SimulatorImpl::fork() const {
+	return new SimulatorImpl(*this);
+}
+
+
 SimulationParams SimulatorImpl::getParameters() const {
 	return params;
 }
 
 
-shared_ptr<Threat> SimulatorImpl::createThreatSim(const SimulationParams& simParams) {
+shared_ptr<Threat> SimulatorImpl::createThreatSim(const SimulationParams& simParams,
+		const SeedContext& seedContext) {
 	shared_ptr<Threat> pThreatSim;
 	if (simParams.optimalityTest) {
 		pThreatSim = make_shared<DeterministicThreat>(
 				simParams.threat.threatRange,
-				simParams.threat.destructionFormationFactor);
+				simParams.threat.destructionFormationFactor,
+				seedContext.getStream(SeedContext::THREAT));
 	} else {
 		pThreatSim = make_shared<Threat>(
 				simParams.threat.threatRange,
-				simParams.threat.destructionFormationFactor);
+				simParams.threat.destructionFormationFactor,
+				seedContext.getStream(SeedContext::THREAT));
 	}
 	return pThreatSim;
 }
 
-shared_ptr<TargetSensor> SimulatorImpl::createTargetSensor(const SimulationParams& simParams) {
+shared_ptr<TargetSensor> SimulatorImpl::createTargetSensor(const SimulationParams& simParams,
+		const SeedContext& seedContext) {
 	shared_ptr<TargetSensor> pTargetSensor;
 	if (simParams.optimalityTest) {
 		pTargetSensor = make_shared<DeterministicTargetSensor>(
 				simParams.downwardLookingSensor.targetSensorRange,
-				simParams.downwardLookingSensor.targetDetectionFormationFactor);
+				simParams.downwardLookingSensor.targetDetectionFormationFactor,
+				seedContext.getStream(SeedContext::TARGET_SENSOR));
 	} else {
 		pTargetSensor = make_shared<TargetSensor>(
 				simParams.downwardLookingSensor.targetSensorRange,
-				simParams.downwardLookingSensor.targetDetectionFormationFactor);
+				simParams.downwardLookingSensor.targetDetectionFormationFactor,
+				seedContext.getStream(SeedContext::TARGET_SENSOR));
 	}
 	return pTargetSensor;
 }
 
 bool SimulatorImpl::finished() const {
-	return destroyed || routeIt == route.end();
+	return destroyed || routeIt == route->end();
 }
 
 SimulationResults SimulatorImpl::getResults() {
@@ -126,33 +252,60 @@ SimulationResults SimulatorImpl::getResults() {
 	results.whereDestroyed = position;
 	results.missionSuccess = !destroyed && targetsDetected >= MISSION_SUCCESS_THRESHOLD;
 	results.decisionTimeAvg = boost::accumulators::mean(decisionTimeStats);
-	results.decisionTimeVar = boost::accumulators::moment<2>(decisionTimeStats);
+	if (decisionTimeHistogram->getCount() > 0) {
+		results.decisionTimeVar = boost::accumulators::variance(decisionTimeStats);
+		results.decisionTimeP50 = decisionTimeHistogram->getQuantile(0.5) / NSEC_PER_MSEC;
+		results.decisionTimeP90 = decisionTimeHistogram->getQuantile(0.9) / NSEC_PER_MSEC;
+		results.decisionTimeP99 = decisionTimeHistogram->getQuantile(0.99) / NSEC_PER_MSEC;
+		results.decisionTimeMax = decisionTimeHistogram->getMax() / NSEC_PER_MSEC;
+	} else {
+		results.decisionTimeVar = results.decisionTimeP50 = results.decisionTimeP90
+				= results.decisionTimeP99 = results.decisionTimeMax
+				= std::numeric_limits<double>::quiet_NaN();
+	}
 	return results;
 }
 
 TeamState SimulatorImpl::getState() {
 	TeamState state;
+	getState(state);
+	return state;
+}
+
+void SimulatorImpl::getState(TeamState& state) {
 	state.position = position;
 	state.config = currentConfig;
 	state.directionX = directionX;
 	state.directionY = directionY;
-	return state;
 }
 
-std::vector<bool> SimulatorImpl::readForwardSensor(const RealEnvironment& environment,
-		Sensor* pSensor, unsigned cells) {
-	std::vector<bool> sensed;
+void SimulatorImpl::getForwardCells(unsigned cells, Route& forwardCells) const {
+	routeGeometry->getForwardCells(routeIt - route->begin(), cells, forwardCells);
+}
 
-	// compute forward sensing route
-	Route route(position, directionX, directionY, cells);
+unsigned SimulatorImpl::getForwardCellsInMap(unsigned cells) const {
+	return getForwardRay(cells).cellsInside;
+}
 
-	for (const auto& pos : route) {
-		if (pos.isInsideRect(environment.getSize())) {
-			sensed.push_back(pSensor->sense(environment.isObjectAt(pos)));
-		} else {
-			break; // the route is a straight line and the environment is convex
-		}
-	}
+unsigned SimulatorImpl::readForwardSensor(const RealEnvironment& environment,
+		Sensor* pSensor, unsigned cells, bool* sensed) {
+	LatencyTimer timer(getHistogram(&SimulatorMetrics::sensing));
+	const auto ray = getForwardRay(cells);
+	RouteGeometry::visitRay(ray, environment, [&](unsigned c, bool isObject) {
+		sensed[c] = pSensor->sense(isObject);
+	});
+
+	return ray.length;
+}
+
+std::vector<bool> SimulatorImpl::readForwardSensor(const RealEnvironment& environment,
+		Sensor* pSensor, unsigned cells) {
+	LatencyTimer timer(getHistogram(&SimulatorMetrics::sensing));
+	const auto ray = getForwardRay(cells);
+	std::vector<bool> sensed(ray.length);
+	RouteGeometry::visitRay(ray, environment, [&](unsigned c, bool isObject) {
+		sensed[c] = pSensor->sense(isObject);
+	});
 
 	return sensed;
 }
@@ -160,30 +313,55 @@ std::vector<bool> SimulatorImpl::readForwardSensor(const RealEnvironment& enviro
 
 std::vector<bool> SimulatorImpl::readForwardThreatSensor(
 		unsigned cells) {
-	return readForwardSensor(threatEnv, pFwdThreatSensor.get(), cells);
+	return readForwardSensor(*threatEnv, pFwdThreatSensor.get(), cells);
 }
 
 std::vector<bool> SimulatorImpl::readForwardTargetSensor(
 		unsigned cells) {
-	return readForwardSensor(targetEnv, pFwdTargetSensor.get(), cells);
+	return readForwardSensor(*targetEnv, pFwdTargetSensor.get(), cells);
+}
+
+unsigned SimulatorImpl::readForwardThreatSensor(unsigned cells, bool* sensed) {
+	return readForwardSensor(*threatEnv, pFwdThreatSensor.get(), cells, sensed);
+}
+
+unsigned SimulatorImpl::readForwardTargetSensor(unsigned cells, bool* sensed) {
+	return readForwardSensor(*targetEnv, pFwdTargetSensor.get(), cells, sensed);
+}
+
+void SimulatorImpl::readForwardSensor(const RealEnvironment& environment,
+		Sensor* pSensor, unsigned cells, unsigned numOfObservations,
+		SensorReadings& readings) {
+	if (numOfObservations > SensorReadings::MAX_OBSERVATIONS) {
+		throw std::invalid_argument("too many observations per cell");
+	}
+
+	LatencyTimer timer(getHistogram(&SimulatorMetrics::sensing));
+	readings.observations = numOfObservations;
+	readings.wordsPerCell = (size_t(numOfObservations) + 63) / 64;
+
+	const auto ray = getForwardRay(cells);
+	readings.cells = ray.length;
+
+	// these only allocate if the buffers have to grow
+	readings.bits.resize(size_t(readings.cells) * readings.wordsPerCell);
+	readings.counts.resize(readings.cells);
+
+	RouteGeometry::visitRay(ray, environment, [&](unsigned c, bool isObject) {
+		readings.counts[c] = pSensor->sense(isObject, numOfObservations,
+				readings.bits.data() + size_t(c) * readings.wordsPerCell);
+	});
 }
 
 std::vector<std::vector<bool>> SimulatorImpl::readForwardSensor(const RealEnvironment& environment,
 		Sensor* pSensor, unsigned cells, unsigned numOfObservations) {
-	std::vector<std::vector<bool>> sensed;
-
-	// compute forward sensing route
-	Route route(position, directionX, directionY, cells);
+	SensorReadings readings;
+	readForwardSensor(environment, pSensor, cells, numOfObservations, readings);
 
-	for (const auto& pos : route) {
-		if (pos.isInsideRect(environment.getSize())) {
-			std::vector<bool> values;
-			for (unsigned c = 0; c < numOfObservations; c++) {
-				values.push_back(pSensor->sense(environment.isObjectAt(pos)));
-			}
-			sensed.push_back(values);
-		} else {
-			break; // the route is a straight line and the environment is convex
+	std::vector<std::vector<bool>> sensed(readings.cells, std::vector<bool>(numOfObservations));
+	for (unsigned c = 0; c < readings.cells; c++) {
+		for (unsigned o = 0; o < numOfObservations; o++) {
+			sensed[c][o] = readings.get(c, o);
 		}
 	}
 
@@ -192,65 +370,119 @@ std::vector<std::vector<bool>> SimulatorImpl::readForwardSensor(const RealEnviro
 
 
 std::vector<std::vector<bool>> SimulatorImpl::readForwardThreatSensor(unsigned cells, unsigned numOfObservations) {
-	return readForwardSensor(threatEnv, pFwdThreatSensor.get(), cells, numOfObservations);
+	return readForwardSensor(*threatEnv, pFwdThreatSensor.get(), cells, numOfObservations);
 }
 
 std::vector<std::vector<bool>> SimulatorImpl::readForwardTargetSensor(unsigned cells, unsigned numOfObservations) {
-	return readForwardSensor(targetEnv, pFwdTargetSensor.get(), cells, numOfObservations);
+	return readForwardSensor(*targetEnv, pFwdTargetSensor.get(), cells, numOfObservations);
+}
+
+void SimulatorImpl::readForwardThreatSensor(unsigned cells, unsigned numOfObservations,
+		SensorReadings& readings) {
+	readForwardSensor(*threatEnv, pFwdThreatSensor.get(), cells, numOfObservations, readings);
+}
+
+void SimulatorImpl::readForwardTargetSensor(unsigned cells, unsigned numOfObservations,
+		SensorReadings& readings) {
+	readForwardSensor(*targetEnv, pFwdTargetSensor.get(), cells, numOfObservations, readings);
+}
+
+std::vector<unsigned> SimulatorImpl::readForwardSensorCounts(const RealEnvironment& environment,
+		Sensor* pSensor, unsigned cells, unsigned numOfObservations) {
+	LatencyTimer timer(getHistogram(&SimulatorMetrics::sensing));
+	const auto ray = getForwardRay(cells);
+	std::vector<unsigned> counts(ray.length);
+	RouteGeometry::visitRay(ray, environment, [&](unsigned c, bool isObject) {
+		counts[c] = pSensor->count(isObject, numOfObservations);
+	});
+
+	return counts;
+}
+
+std::vector<unsigned> SimulatorImpl::readForwardThreatSensorCounts(unsigned cells,
+		unsigned numOfObservations) {
+	return readForwardSensorCounts(*threatEnv, pFwdThreatSensor.get(), cells, numOfObservations);
+}
+
+std::vector<unsigned> SimulatorImpl::readForwardTargetSensorCounts(unsigned cells,
+		unsigned numOfObservations) {
+	return readForwardSensorCounts(*targetEnv, pFwdTargetSensor.get(), cells, numOfObservations);
 }
 
 void SimulatorImpl::updateDirection() {
-	directionX = 0;
-	directionY = 0;
-	if (routeIt != route.end()) {
-		auto nextPos = routeIt + 1;
-		directionX = nextPos->x - position.x;
-		directionY = nextPos->y - position.y;
-	}
+	const Coordinate direction = routeGeometry->getDirection(routeIt - route->begin());
+	directionX = direction.x;
+	directionY = direction.y;
 }
 
 bool SimulatorImpl::step(const TacticList& tactics, double decisionTimeMsec) {
+	TacticSet tacticSet;
+	for (const auto& label : tactics) {
+		Tactic tactic = Tactic::INC_ALTITUDE;
+		if (!findTactic(label.data(), label.size(), tactic)) {
+			throw std::runtime_error(string("unknown tactic ") + label);
+		}
+		tacticSet.insert(tactic);
+	}
+	return step(tacticSet, decisionTimeMsec);
+}
+
+bool SimulatorImpl::step(TacticSet tactics, double decisionTimeMsec) {
 	bool targetDetectedInThisStep = false;
 	if (finished()) {
 		return targetDetectedInThisStep;
 	}
 
-	// collect decision time
-	decisionTimeStats(decisionTimeMsec);
+	recordDecisionTime(decisionTimeMsec);
 
-	for (auto tactic : tactics) {
-		currentConfig = executeTactic(tactic, currentConfig);
+	if (!tactics.empty()) {
+		LatencyTimer timer(getHistogram(&SimulatorMetrics::tactics));
+		currentConfig = executeTactics(tactics, currentConfig);
+		for (auto tactic : EXECUTION_ORDER) {
+			if (tactics.contains(tactic)) {
+				eventSink->tacticExecuted(position, tactic);
+			}
+		}
 	}
 
-	/* update display */
-	screen[screenPosition][currentConfig.altitudeLevel - 1] =
-			(currentConfig.formation
-					== TeamConfiguration::Formation::LOOSE) ?
-					(currentConfig.ecm ? '@' : '#') :
-					(currentConfig.ecm ? '0' : '*');
+	/* record step for the display */
+	if (params.recordTrajectory) {
+		recordTrajectoryPoint({currentConfig.altitudeLevel, currentConfig.formation,
+			currentConfig.ecm, false});
+	}
 
 	/* simulate threats */
-	destroyed = pThreatSim->isDestroyed(threatEnv, currentConfig, position);
+	{
+		LatencyTimer timer(getHistogram(&SimulatorMetrics::threats));
+		destroyed = pThreatSim->isDestroyed(*threatEnv, currentConfig, position);
+	}
 	if (destroyed) {
-		cout << "Team destroyed at position " << position << endl;
+		eventSink->teamDestroyed(position);
 		return targetDetectedInThisStep;
 	}
 
 	/* simulate target detection */
-	if (pTargetSensor->sense(currentConfig, targetEnv.isObjectAt(position))) {
-		cout << "Target detected at " << position << endl;
+	bool targetDetected;
+	{
+		LatencyTimer timer(getHistogram(&SimulatorMetrics::targets));
+		targetDetected = pTargetSensor->sense(currentConfig, targetEnv->isObjectAt(position));
+	}
+	if (targetDetected) {
+		eventSink->targetDetected(position);
 		targetsDetected++;
 		targetDetectedInThisStep = true;
-		screen[screenPosition][SCREEN_TARGETS] = 'X';
+		if (params.recordTrajectory) {
+			// the point was recorded in this step, so no snapshot shares it
+			trajectory->points.back().targetDetected = true;
+		}
 	}
 
 	/* system evolution */
 	routeIt++;
-	if (routeIt != route.end()) {
+	if (routeIt != route->end()) {
 		position = *routeIt;
 	}
 	updateDirection();
-	screenPosition++;
 
 	/* update tactic progress */
 	auto ttcIncAlt = currentConfig.ttcIncAlt;
@@ -288,63 +520,122 @@ bool SimulatorImpl::step(const TacticList& tactics, double decisionTimeMsec) {
 	return targetDetectedInThisStep;
 }
 
-TeamConfiguration SimulatorImpl::executeTactic(string tactic, const TeamConfiguration& config) {
+TeamConfiguration SimulatorImpl::executeTactics(TacticSet tactics, const TeamConfiguration& config) {
 	auto newConfig = config;
-	cout << "executing tactic " << tactic << endl;
-	if (tactic == INC_ALTITUDE) {
-		if (changeAltitudeLatencyPeriods > 0) {
+
+	if (changeAltitudeLatencyPeriods > 0) {
+		if (tactics.contains(Tactic::INC_ALTITUDE)) {
 			newConfig.ttcIncAlt = changeAltitudeLatencyPeriods;
-		} else {
-			newConfig.altitudeLevel = newConfig.altitudeLevel + 1;
 		}
-	} else if (tactic == DEC_ALTITUDE) {
-		if (changeAltitudeLatencyPeriods > 0) {
+		if (tactics.contains(Tactic::DEC_ALTITUDE)) {
 			newConfig.ttcDecAlt = changeAltitudeLatencyPeriods;
-		} else {
-			newConfig.altitudeLevel = newConfig.altitudeLevel - 1;
 		}
-	} else if (tactic == INC_ALTITUDE2) {
-		if (changeAltitudeLatencyPeriods > 0) {
+		if (tactics.contains(Tactic::INC_ALTITUDE2)) {
 			newConfig.ttcIncAlt2 = changeAltitudeLatencyPeriods;
-		} else {
-			newConfig.altitudeLevel = newConfig.altitudeLevel + 2;
 		}
-	} else if (tactic == DEC_ALTITUDE2) {
-		if (changeAltitudeLatencyPeriods > 0) {
+		if (tactics.contains(Tactic::DEC_ALTITUDE2)) {
 			newConfig.ttcDecAlt2 = changeAltitudeLatencyPeriods;
-		} else {
-			newConfig.altitudeLevel = newConfig.altitudeLevel - 2;
 		}
-	} else if (tactic == GO_TIGHT) {
+	} else {
+		newConfig.altitudeLevel = newConfig.altitudeLevel
+				+ tactics.contains(Tactic::INC_ALTITUDE)
+				+ 2 * tactics.contains(Tactic::INC_ALTITUDE2)
+				- tactics.contains(Tactic::DEC_ALTITUDE)
+				- 2 * tactics.contains(Tactic::DEC_ALTITUDE2);
+	}
+
+	/*
+	 * when opposite tactics are executed together, the one executed last
+	 * in EXECUTION_ORDER prevails
+	 */
+	if (tactics.contains(Tactic::GO_TIGHT)) {
 		newConfig.formation = TeamConfiguration::Formation::TIGHT;
-	} else if (tactic == GO_LOOSE) {
+	} else if (tactics.contains(Tactic::GO_LOOSE)) {
 		newConfig.formation = TeamConfiguration::Formation::LOOSE;
-	} else if (tactic == ECM_ON) {
+	}
+
+	if (tactics.contains(Tactic::ECM_ON)) {
 		newConfig.ecm = true;
-	} else if (tactic == ECM_OFF) {
+	} else if (tactics.contains(Tactic::ECM_OFF)) {
 		newConfig.ecm = false;
-	} else {
-		throw std::runtime_error(string("unknown tactic ") + tactic);
 	}
+
 	return newConfig;
 }
 
 
 std::string SimulatorImpl::getScreenOutput() {
-	ostringstream out;
-	for (int h = SCREEN_THREATS; h > 0 ; h--) {
-		for (unsigned p = 0; p < screen.size(); p++) {
-			out << screen[p][h - 1];
+
+	/* render the rows of the screen, from the ground up */
+	vector<string> rows(SCREEN_TARGETS + 1, string(route->size(), ' '));
+	for (unsigned p = 0; p < route->size(); p++) {
+		if (threatEnv->isObjectAt(route->at(p))) {
+			rows[SCREEN_THREATS][p] = '^';
+		}
+		if (targetEnv->isObjectAt(route->at(p))) {
+			rows[SCREEN_TARGETS][p] = 'T';
+		}
+	}
+
+	for (unsigned p = 0; p < trajectoryLength; p++) {
+		const auto& point = trajectory->points[p];
+		if (point.altitudeLevel > 0 && point.altitudeLevel <= rows.size()) {
+			rows[point.altitudeLevel - 1][p] =
+					(point.formation == TeamConfiguration::Formation::LOOSE) ?
+							(point.ecm ? '@' : '#') :
+							(point.ecm ? '0' : '*');
 		}
-		out << endl;
+		if (point.targetDetected) {
+			rows[SCREEN_TARGETS][p] = 'X';
+		}
+	}
+
+	string out;
+	for (int h = SCREEN_THREATS; h > 0 ; h--) {
+		out += rows[h - 1];
+		out += '\n';
 	}
-	for (int h = SCREEN_THREATS; h < SCREEN_THREATS + 2; h++) {
-		for (unsigned p = 0; p < screen.size(); p++) {
-			out << screen[p][h];
+	out += rows[SCREEN_THREATS];
+	out += '\n';
+	out += rows[SCREEN_TARGETS];
+	out += '\n';
+	return out;
+}
+
+void SimulatorImpl::recordTrajectoryPoint(const TrajectoryPoint& point) {
+	if (!trajectory) {
+		trajectory = make_shared<SharedTrajectory>();
+		trajectory->points.reserve(route->size());
+	} else if (trajectory->points.size() > trajectoryLength) {
+
+		/* drop the points after a restored snapshot, unless other snapshots may share them */
+		if (trajectory->sharedLength > trajectoryLength && trajectory.use_count() > 1) {
+			auto prefix = make_shared<SharedTrajectory>();
+			prefix->points.reserve(route->size());
+			prefix->points.assign(trajectory->points.begin(),
+					trajectory->points.begin() + trajectoryLength);
+			trajectory = prefix;
+		} else {
+			trajectory->points.resize(trajectoryLength);
+			trajectory->sharedLength = std::min(trajectory->sharedLength, trajectoryLength);
 		}
-		out << endl;
 	}
-	return out.str();
+	trajectory->points.push_back(point);
+	trajectoryLength++;
+}
+
+void SimulatorImpl::recordDecisionTime(double decisionTimeMsec) {
+	decisionTimeStats(decisionTimeMsec);
+	if (decisionTimeHistogram.use_count() > 1) {
+
+		/* the histogram is shared with a snapshot */
+		decisionTimeHistogram = make_shared<LatencyHistogram>(*decisionTimeHistogram);
+	}
+	decisionTimeHistogram->record((decisionTimeMsec > 0.0) ? uint64_t(decisionTimeMsec * NSEC_PER_MSEC + 0.5) : 0);
+}
+
+SimulatorMetrics SimulatorImpl::getMetrics() const {
+	return (pMetrics) ? *pMetrics : SimulatorMetrics();
 }
 
 SimulatorImpl::~SimulatorImpl() {
@@ -29,9 +29,11 @@
 #pragma once
 #include <dartsim/Simulator.h>
 #include "RealEnvironment.h"
+#include "RouteGeometry.h"
 #include "Sensor.h"
 #include "Threat.h"
 #include "TargetSensor.h"
+#include "SeedContext.h"
 #include <memory>
 #include <vector>
 #include <string>
@@ -39,20 +41,79 @@
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 #include <boost/accumulators/statistics/mean.hpp>
-#include <boost/accumulators/statistics/moment.hpp>
+#include <boost/accumulators/statistics/variance.hpp>
 
 using Stats = boost::accumulators::accumulator_set<double,
         boost::accumulators::stats<boost::accumulators::tag::mean,
-                boost::accumulators::tag::moment<2> > >;
+                boost::accumulators::tag::variance> >;
 
 namespace dart {
 namespace sim {
 
 class SimulatorImpl : public Simulator {
+	friend class BatchSimulator;
+	friend class BatchRunner;
+
+	/**
+	 * What the screen shows for one step of the mission
+	 */
+	struct TrajectoryPoint {
+		unsigned altitudeLevel;
+		TeamConfiguration::Formation formation;
+		bool ecm;
+		bool targetDetected;
+	};
+	using Trajectory = std::vector<TrajectoryPoint>;
+
+	/**
+	 * Trajectory shared by a simulator and its snapshots
+	 */
+	struct SharedTrajectory {
+		Trajectory points;
+		size_t sharedLength = 0; /**< points that snapshots may share, which are never modified */
+	};
+
+	/**
+	 * Snapshot of the state that changes during the simulation
+	 */
+	class Snapshot : public SimulatorSnapshot {
+	public:
+		Snapshot(const SimulatorImpl& simulator);
+
+		std::shared_ptr<const Route> route; /**< identifies the mission */
+		Sensor fwdThreatSensor;
+		Sensor fwdTargetSensor;
+		std::shared_ptr<const TargetSensor> pTargetSensor;
+		std::shared_ptr<const Threat> pThreatSim;
+
+		/**
+		 * Trajectory shared with the simulator, of which only the first
+		 * trajectoryLength points belong to the snapshot
+		 */
+		std::shared_ptr<SharedTrajectory> trajectory;
+		size_t trajectoryLength;
+		Stats decisionTimeStats;
+		std::shared_ptr<LatencyHistogram> decisionTimeHistogram; /**< shared with the simulator */
+		TeamConfiguration currentConfig;
+		unsigned targetsDetected;
+		bool destroyed;
+		size_t routeIndex;
+		Coordinate position;
+		int directionX;
+		int directionY;
+	};
+
 	SimulationParams params;
-	RealEnvironment threatEnv;
-	RealEnvironment targetEnv;
-	Route route;
+	SeedContext seedContext;
+
+	/*
+	 * The environment and the route never change during a mission, so they
+	 * are shared by the forks of the simulator
+	 */
+	std::shared_ptr<const RealEnvironment> threatEnv;
+	std::shared_ptr<const RealEnvironment> targetEnv;
+	std::shared_ptr<const Route> route;
+	std::shared_ptr<const RouteGeometry> routeGeometry;
 
 	std::unique_ptr<Sensor> pFwdThreatSensor;
 	std::unique_ptr<Sensor> pFwdTargetSensor;
@@ -60,9 +121,35 @@ class SimulatorImpl : public Simulator {
 	std::shared_ptr<TargetSensor> pTargetSensor;
 	std::shared_ptr<Threat> pThreatSim;
 
-	std::vector<std::vector<char> > screen;
-	unsigned screenPosition = 0;
+	std::shared_ptr<EventSink> eventSink; /**< never null */
+
+	/**
+	 * Latency histograms, which are only allocated if
+	 * params.collectMetrics is true
+	 */
+	std::unique_ptr<SimulatorMetrics> pMetrics;
+
+	/**
+	 * Steps of the mission so far, from which the screen is rendered
+	 *
+	 * Only the first trajectoryLength points belong to the mission. The
+	 * points after them were recorded before restoring a snapshot, and may
+	 * still belong to other snapshots. Snapshots share the trajectory
+	 * instead of copying it, so the points that a snapshot may share are
+	 * never modified.
+	 *
+	 * It is null if params.recordTrajectory is false
+	 */
+	std::shared_ptr<SharedTrajectory> trajectory;
+	size_t trajectoryLength = 0;
+
 	Stats decisionTimeStats;
+
+	/**
+	 * Decision times in nanoseconds, which are shared with the snapshots
+	 * and copied before recording if they are
+	 */
+	std::shared_ptr<LatencyHistogram> decisionTimeHistogram;
 	TeamConfiguration currentConfig;
 	unsigned targetsDetected = 0;
 	bool destroyed = false;
@@ -93,15 +180,19 @@ class SimulatorImpl : public Simulator {
 public:
 	typedef std::set<std::string> TacticList; /**< a set of tactic labels */
 
-	SimulatorImpl(const SimulationParams& simParams,
+	SimulatorImpl(const SimulationParams& simParams, const SeedContext& seedContext,
 			const RealEnvironment& threatEnv, const RealEnvironment& targetEnv,
-			const Route& route, unsigned missionSuccessTargetThreshold);
+			std::shared_ptr<const Route> route, unsigned missionSuccessTargetThreshold);
 
 	SimulationParams getParameters() const;
 
 	bool finished() const;
 
 	TeamState getState();
+	void getState(TeamState& state);
+
+	void getForwardCells(unsigned cells, Route& forwardCells) const;
+	unsigned getForwardCellsInMap(unsigned cells) const;
 
 	/**
 	 * Read the forward-looking threat sensor
@@ -116,9 +207,20 @@ public:
 	std::vector<bool> readForwardThreatSensor(unsigned cells);
 	std::vector<bool> readForwardTargetSensor(unsigned cells);
 
+	unsigned readForwardThreatSensor(unsigned cells, bool* sensed);
+	unsigned readForwardTargetSensor(unsigned cells, bool* sensed);
+
 	std::vector<std::vector<bool> > readForwardThreatSensor(unsigned cells, unsigned numOfObservations);
 	std::vector<std::vector<bool> > readForwardTargetSensor(unsigned cells, unsigned numOfObservations);
 
+	void readForwardThreatSensor(unsigned cells, unsigned numOfObservations,
+			SensorReadings& readings);
+	void readForwardTargetSensor(unsigned cells, unsigned numOfObservations,
+			SensorReadings& readings);
+
+	std::vector<unsigned> readForwardThreatSensorCounts(unsigned cells, unsigned numOfObservations);
+	std::vector<unsigned> readForwardTargetSensorCounts(unsigned cells, unsigned numOfObservations);
+
 
 	/**
 	 * Executes one simulation step
@@ -126,6 +228,7 @@ public:
 	 * @return true if target was detected
 	 */
 	bool step(const TacticList& tactics, double decisionTimeMsec = 0.0);
+	bool step(TacticSet tactics, double decisionTimeMsec = 0.0);
 
 	SimulationResults getResults();
 
@@ -136,21 +239,65 @@ public:
 	 */
 	std::string getScreenOutput();
 
+	SimulatorMetrics getMetrics() const;
+
+	std::shared_ptr<const SimulatorSnapshot> snapshot() const;
+
+	void restore(const SimulatorSnapshot& snapshot);
+
+	Simulator* fork() const;
+
 	virtual ~SimulatorImpl();
 
 private:
+	SimulatorImpl(const SimulatorImpl& simulator);
+	SimulatorImpl& operator=(const SimulatorImpl&) = delete;
+
+	void recordTrajectoryPoint(const TrajectoryPoint& point);
+
+	void recordDecisionTime(double decisionTimeMsec);
+
 	std::vector<bool> readForwardSensor(const RealEnvironment& environment,
 			Sensor* pSensor,
 			unsigned cells);
 
+	unsigned readForwardSensor(const RealEnvironment& environment,
+			Sensor* pSensor,
+			unsigned cells, bool* sensed);
+
 	std::vector<std::vector<bool> > readForwardSensor(const RealEnvironment& environment,
 			Sensor* pSensor,
 			unsigned cells, unsigned numOfObservations);
 
-	static std::shared_ptr<Threat> createThreatSim(const SimulationParams& simParams);
-	static std::shared_ptr<TargetSensor> createTargetSensor(const SimulationParams& simParams);
-	TeamConfiguration executeTactic(std::string tactic, const TeamConfiguration& config);
+	void readForwardSensor(const RealEnvironment& environment,
+			Sensor* pSensor,
+			unsigned cells, unsigned numOfObservations,
+			SensorReadings& readings);
+
+	std::vector<unsigned> readForwardSensorCounts(const RealEnvironment& environment,
+			Sensor* pSensor,
+			unsigned cells, unsigned numOfObservations);
+
+	static std::shared_ptr<Threat> createThreatSim(const SimulationParams& simParams,
+			const SeedContext& seedContext);
+	static std::shared_ptr<TargetSensor> createTargetSensor(const SimulationParams& simParams,
+			const SeedContext& seedContext);
+	TeamConfiguration executeTactics(TacticSet tactics, const TeamConfiguration& config);
 	void updateDirection();
+
+	/**
+	 * @return the cells that the forward-looking sensors can sense
+	 */
+	RouteGeometry::Ray getForwardRay(unsigned cells) const {
+		return routeGeometry->getForwardRay(routeIt - route->begin(), cells);
+	}
+
+	/**
+	 * @return the histogram if metrics are being collected, or nullptr
+	 */
+	LatencyHistogram* getHistogram(LatencyHistogram SimulatorMetrics::* histogram) {
+		return (pMetrics) ? &(pMetrics.get()->*histogram) : nullptr;
+	}
 };
 
 } /* namespace sim */
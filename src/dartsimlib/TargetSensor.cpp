@@ -28,7 +28,6 @@
 
 #include "TargetSensor.h"
 #include <algorithm>
-#include "RandomSeed.h"
 #include <iostream>
 
 using namespace std;
@@ -36,16 +35,20 @@ using namespace std;
 namespace dart {
 namespace sim {
 
-TargetSensor::TargetSensor(double range, double detectionFormationFactor)
+TargetSensor::TargetSensor(double range, double detectionFormationFactor, RandomStream randomStream)
 	: range(range),
 	  detectionFormationFactor(detectionFormationFactor),
-	  randomGenerator(RandomSeed::getNextSeed())
+	  randomStream(randomStream)
 {
 }
 
 TargetSensor::~TargetSensor() {
 }
 
+shared_ptr<TargetSensor> TargetSensor::clone() const {
+	return make_shared<TargetSensor>(*this);
+}
+
 double TargetSensor::getProbabilityOfDetection(const TeamConfiguration& config) {
 	double probOfDetection =
 			((config.formation == TeamConfiguration::Formation::LOOSE) ? 1.0 : 1 / detectionFormationFactor)
@@ -64,7 +67,7 @@ bool TargetSensor::sense(const TeamConfiguration& config, bool targetPresent) {
 	if (targetPresent) {
 		double probOfDetection = getProbabilityOfDetection(config);
 
-		double random = uniform(randomGenerator);
+		double random = randomStream.uniform();
 		detected = (random <= probOfDetection);
 	}
 	return detected;
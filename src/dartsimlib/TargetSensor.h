@@ -29,15 +29,21 @@
 #pragma once
 
 #include <dartsim/TeamConfiguration.h>
-#include <random>
+#include "RandomStream.h"
+#include <memory>
 
 namespace dart {
 namespace sim {
 
 class TargetSensor {
 public:
-	TargetSensor(double range, double detectionFormationFactor);
+	TargetSensor(double range, double detectionFormationFactor, RandomStream randomStream);
 	virtual ~TargetSensor();
+
+	/**
+	 * Creates a copy of this object, including the state of its random stream
+	 */
+	virtual std::shared_ptr<TargetSensor> clone() const;
 	virtual bool sense(const TeamConfiguration& config, bool targetPresent);
 
 	/**
@@ -48,8 +54,7 @@ public:
 protected:
 	double range;
 	double detectionFormationFactor;
-	std::uniform_real_distribution<> uniform;
-	std::default_random_engine randomGenerator;
+	RandomStream randomStream;
 };
 
 } /* namespace sim */
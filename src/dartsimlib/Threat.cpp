@@ -28,23 +28,26 @@
 
 #include "Threat.h"
 #include <algorithm>
-#include "RandomSeed.h"
 
 using namespace std;
 
 namespace dart {
 namespace sim {
 
-Threat::Threat(double range, double destructionFormationFactor)
+Threat::Threat(double range, double destructionFormationFactor, RandomStream randomStream)
 	: range(range),
 	  destructionFormationFactor(destructionFormationFactor),
-	  randomGenerator(RandomSeed::getNextSeed())
+	  randomStream(randomStream)
 {
 }
 
 Threat::~Threat() {
 }
 
+shared_ptr<Threat> Threat::clone() const {
+	return make_shared<Threat>(*this);
+}
+
 double Threat::getProbabilityOfDestruction(const TeamConfiguration& config) {
 	double probOfDestruction =
 			((config.formation == TeamConfiguration::Formation::LOOSE) ? 1.0 : (1.0 / destructionFormationFactor))
@@ -65,7 +68,7 @@ bool Threat::isDestroyed(const RealEnvironment& threatEnv,
 	if (threat) {
 		double probOfDestruction = getProbabilityOfDestruction(config);
 
-		double random = uniform(randomGenerator);
+		double random = randomStream.uniform();
 		destroyed = (random <= probOfDestruction);
 	}
 	return destroyed;
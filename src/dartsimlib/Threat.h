@@ -30,7 +30,8 @@
 
 #include "RealEnvironment.h"
 #include <dartsim/TeamConfiguration.h>
-#include <random>
+#include "RandomStream.h"
+#include <memory>
 
 namespace dart {
 namespace sim {
@@ -40,9 +41,14 @@ namespace sim {
  */
 class Threat {
 public:
-	Threat(double range, double destructionFormationFactor);
+	Threat(double range, double destructionFormationFactor, RandomStream randomStream);
 	virtual ~Threat();
 
+	/**
+	 * Creates a copy of this object, including the state of its random stream
+	 */
+	virtual std::shared_ptr<Threat> clone() const;
+
 	/**
 	 * Simulates the effect of a (possible) threat
 	 *
@@ -61,8 +67,7 @@ public:
 protected:
 	double range;
 	double destructionFormationFactor;
-	std::uniform_real_distribution<> uniform;
-	std::default_random_engine randomGenerator;
+	RandomStream randomStream;
 };
 
 } /* namespace sim */